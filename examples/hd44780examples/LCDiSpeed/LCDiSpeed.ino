@@ -118,6 +118,13 @@ static const int dummyvar = 0; // dummy declaration for older broken IDEs!!!!
 //#define LCD_CHEXECTIME 2000
 //#define LCD_INSEXECTIME 38
 
+// uncomment this to use the cpu cycle counter rather than micros()
+// to track execution times on processors that have one.
+// On AVR, Timer1 is used instead. (this takes over Timer1)
+// Compare ByteXfer with and without it. (see hd44780 setTimeSource())
+
+//#define LCD_CYCLECOUNT
+
 
 /*----------------------------------------------------------------------------*
  * LCDiSpeed Options (normally should not need to change these)
@@ -163,6 +170,16 @@ void setup(void)
 		lcd.setExecTimes(LCD_CHEXECTIME, LCD_INSEXECTIME);
 #endif
 
+		// use cycle counter time source if configured
+#if defined(LCD_CYCLECOUNT) && defined(HD44780_CYCLECOUNT)
+		lcd.setTimeSource(hd44780::cycleCount, F_CPU/1000000);
+#elif defined(LCD_CYCLECOUNT) && defined(HD44780_TIMER1COUNT)
+		// free running Timer1 at F_CPU/8
+		TCCR1A = 0;
+		TCCR1B = _BV(CS11);
+		lcd.setTimeSource(hd44780::timer1Count, F_CPU/8000000);
+#endif
+
 
 	if(lcd.begin(LCD_COLS, LCD_ROWS))
 	{
@@ -189,6 +206,9 @@ void setup(void)
 #ifdef WIRECLOCK
 #if defined(WIRE_HAS_SETCLOCK) || ((ARDUINO >= 157) && !defined(MPIDE))
 	Wire.setClock(WIRECLOCK); // set i2c clock bit rate, if asked
+#if defined(hd44780_I2Cexp_h)
+	lcd.setBusClock(WIRECLOCK); // tell hd44780_I2Cexp the new clock rate
+#endif
 #else
 #error attempting to use Wire.setClock on IDE that does not support it
 #endif
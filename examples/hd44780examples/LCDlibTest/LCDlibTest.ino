@@ -239,6 +239,9 @@ Serial.println("LCD initialized");
 #ifdef WIRECLOCK
 #if (ARDUINO >= 157) && !defined(MPIDE)
 	Wire.setClock(WIRECLOCK); // set i2c clock bit rate, if asked
+#if defined(hd44780_I2Cexp_h)
+	lcd.setBusClock(WIRECLOCK); // tell hd44780_I2Cexp the new clock rate
+#endif
 #else
 #error attempting to use Wire.setClock on IDE that does not support it
 #endif
@@ -57,6 +57,9 @@ void setup()
 #ifdef WIRECLOCK
 #if (ARDUINO > 10507) && !defined(MPIDE)
 	Wire.setClock(WIRECLOCK); // set i2c clock bit rate, if asked
+#if defined(hd44780_I2Cexp_h)
+	lcd.setBusClock(WIRECLOCK); // tell hd44780_I2Cexp the new clock rate
+#endif
 #endif
 #endif
 
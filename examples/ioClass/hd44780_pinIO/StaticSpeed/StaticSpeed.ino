@@ -0,0 +1,101 @@
+// vi:ts=4
+// ----------------------------------------------------------------------------
+// StaticSpeed - compare per byte s/w overhead of hd44780_static
+// ----------------------------------------------------------------------------
+//
+// This sketch is for LCDs that are directly controlled with Arduino pins.
+//
+// Sketch declares two lcd objects on the same Arduino pins,
+// a normal hd44780_pinIO object and a hd44780_static<hd44780_pinIO> object
+// which calls the i/o class directly rather than through virtual functions.
+// Each one writes a number of bytes to the LCD and the average time per byte
+// is shown for each along with the processor cycles per byte.
+//
+// The LCD execution times are set to zero while timing, so the times
+// are only the s/w overhead and the Arduino pin i/o, not the time
+// spent waiting for the LCD.
+// The LCD may show garbage while timing, it is cleared afterwards.
+//
+// See the HelloWorld sketch for configuring the Arduino pins used.
+// ----------------------------------------------------------------------------
+
+#include <hd44780.h>
+#include <hd44780ioClass/hd44780_pinIO.h> // Arduino pin i/o class header
+#include <hd44780util/hd44780_static.h>
+
+// declare Arduino pins used for LCD functions
+// and the lcd objects
+// note that ESP8266 based arduinos must use the Dn defines rather than
+// raw pin numbers.
+#if defined (ARDUINO_ARCH_ESP8266)
+// esp8266 Lolin/Wemos D1 R1 (uno form factor)
+const int rs=D8, en=D9, db4=D4, db5=D5, db6=D6, db7=D7;
+#elif defined(ARDUINO_ARCH_ESP32)
+// esp32 espduino32 D1 R32 (uno form factor)
+// note: GPIO12 needs a pulldown resistor
+const int rs=12, en=13, db4=17, db5=16, db6=27, db7=14;
+#else
+const int rs=8, en=9, db4=4, db5=5, db6=6, db7=7;       // for all other devices
+#endif
+hd44780_pinIO lcd(rs, en, db4, db5, db6, db7);
+hd44780_static<hd44780_pinIO> slcd(rs, en, db4, db5, db6, db7);
+
+// LCD geometry
+const int LCD_COLS = 16;
+const int LCD_ROWS = 2;
+
+const int NBYTES = 1000; // bytes to write for each timing
+
+// timeBytes() - returns average time in us to write a byte
+float timeBytes(hd44780 &dev, size_t (*writefunc)(uint8_t))
+{
+uint32_t chExecTime, insExecTime;
+unsigned long stime, etime;
+
+	dev.getExecTimes(chExecTime, insExecTime);
+	dev.setExecTimes(0, 0); // only measure the s/w overhead
+
+	dev.setCursor(0,0);
+	stime = micros();
+	for(int i = 0; i < NBYTES; i++)
+		writefunc('0' + (i % 10));
+	etime = micros() - stime;
+
+	dev.setExecTimes(chExecTime, insExecTime);
+	return((float) etime / NBYTES);
+}
+
+// call write() using the object type so hd44780_static write() is used
+size_t lcdwrite(uint8_t c) { return(lcd.write(c)); }
+size_t slcdwrite(uint8_t c) { return(slcd.write(c)); }
+
+void showTime(hd44780 &dev, uint8_t row, const char *name, float us)
+{
+	dev.setCursor(0, row);
+	dev.print(name);
+	dev.print(us, 2);
+	dev.print("us");
+#if defined(F_CPU)
+	// processor cycles per byte
+	dev.print(' ');
+	dev.print((unsigned long) (us * (F_CPU / 1000000.0) + 0.5));
+#endif
+}
+
+void setup()
+{
+float us, sus;
+
+	lcd.begin(LCD_COLS, LCD_ROWS);
+	us = timeBytes(lcd, lcdwrite);
+
+	slcd.begin(LCD_COLS, LCD_ROWS);
+	sus = timeBytes(slcd, slcdwrite);
+
+	// show the results
+	slcd.clear();
+	showTime(slcd, 0, "V:", us);
+	showTime(slcd, 1, "S:", sus);
+}
+
+void loop() {}
@@ -36,6 +36,12 @@ const int rs=8, en=9, db4=4, db5=5, db6=6, db7=7;       // for all other devices
 #endif
 hd44780_pinIO lcd(rs, en, db4, db5, db6, db7);
 
+// To compare the per byte overhead with static i/o class binding
+// use this instead of the hd44780_pinIO lcd object above.
+// (the StaticSpeed example times both without the LCD waits)
+//#include <hd44780util/hd44780_static.h>
+//hd44780_static<hd44780_pinIO> lcd(rs, en, db4, db5, db6, db7);
+
 //with backlight control:
 //	backlight control requires two additional parameters
 //	- an additional pin to control the backlight
@@ -103,34 +103,62 @@ hd44780::hd44780() : _cols(0), _rows(0)
 	 */
 
 	setExecTimes(HD44780_CHEXECTIME, HD44780_INSEXECTIME);
-
-	// clear row offset addresses, will be set in begin()
-	setRowOffsets(0,0,0,0);
-
-	noLineWrap(); // no linewrap as default
-
-	markStart(0); // initialize last start time to 'now'
+	initState();
 }
 
 hd44780::hd44780(uint8_t cols, uint8_t rows) : _cols(cols), _rows(rows)
 {
-	// clear row offset addresses, will be set in begin()
-	setRowOffsets(0,0,0,0);
-
-	noLineWrap(); // no linewrap as default
-
 	setExecTimes(HD44780_CHEXECTIME, HD44780_INSEXECTIME);
-	markStart(0); // initialize last start time to 'now'
+	initState();
 }
 
 hd44780::hd44780(uint8_t cols, uint8_t rows, uint32_t chExecTimeUs, uint32_t insExecTimeus) :
 		 _cols(cols), _rows(rows), _chExecTime(chExecTimeUs), _insExecTime(insExecTimeus)
+{
+	initState();
+}
+
+// initState() - set the default state shared by all the constructors
+// geometry and execution times are set by the constructors
+void hd44780::initState(void)
 {
 	// clear row offset addresses, will be set in begin()
 	setRowOffsets(0,0,0,0);
 
 	noLineWrap(); // no linewrap as default
 
+	noShadowBuffer(); // no shadow buffer as default
+
+	noBusyPoll(); // timed waits as default
+
+	noFastClear(); // clear/home instructions as default
+
+	_qbuf = 0; // no command queue as default
+
+	setIdleCallback(0); // no idle callback as default
+
+	_timefunc = 0; // micros() as default time source
+	_ticksPerUs = 1;
+
+	_ioXferTime = 0; // i/o class transfer time is not known
+
+	_ddramAddr = 0xff; // LCD address counter is not known
+	_entryMode = HD44780_ENTRYLEFT2RIGHT;
+	_shift = 0;
+
+	_mqText = 0; // no marquee
+	_dblBuf = 0; // no double buffering
+
+	// single controller as default, i/o class can enable a 2nd controller
+	_nctl = 1;
+	_ctl = 0;
+	_ctlSel = 0;
+	_ctlAddr[0] = _ctlAddr[1] = 0xff; // not known
+	_ctlExec[0] = _ctlExec[1] = 0;
+	_ctlStart[0] = _ctlStart[1] = 0;
+	_ctlRow = 0xff;
+	_cgram = 0;
+
 	markStart(0); // initialize last start time to 'now'
 }
 
@@ -168,7 +196,17 @@ int hd44780::init()
 int hd44780::begin(uint8_t cols, uint8_t rows, uint8_t dotsize)
 {
 int rval = 0;
+uint8_t busypoll = _busyPoll;
+uint8_t *qbuf;
+
+
+	// the busy flag cannot be used until the LCD is initialized
+	_busyPoll = 0;
 
+	// the initialization sequence is not queued
+	flushQueue();
+	qbuf = _qbuf;
+	_qbuf = 0;
 
 	/*
 	 * Limit lines/rows to max in the row offset table
@@ -198,9 +236,24 @@ int rval = 0;
 	if((!_rowOffsets[0] && !_rowOffsets[1] && !_rowOffsets[2] && !_rowOffsets[3])
 	 || (_cols && (_cols != cols)))
 	{
-		setRowOffsets(0x00, 0x40, 0x00 + cols, 0x40 + cols);
+		if(_nctl > 1)
+			setRowOffsets(0x00, 0x40, 0x00, 0x40); // two 2 line controllers
+		else
+			setRowOffsets(0x00, 0x40, 0x00 + cols, 0x40 + cols);
 	}
 
+	/*
+	 * dual controller displays (40x4) have the 2nd half of the rows
+	 * on the 2nd controller
+	 */
+	if(_nctl > 1)
+		_ctlRow = (rows + 1) / 2;
+	else
+		_ctlRow = 0xff;
+	apiCtl(0);
+	_cgram = 0;
+	_displaycontrol = 0; // no cursor to move between controllers during init
+
 
 	/*
 	 * Save rows/cols
@@ -208,6 +261,12 @@ int rval = 0;
 	_rows = rows;
 	_cols = cols;
 
+	/*
+	 * drop the shadow buffer if it is too small for the new geometry
+	 */
+	if(_shadow && (_shadowSize < (size_t) HD44780_SHADOWSIZE(_cols, _rows)))
+		noShadowBuffer();
+
 	/*
 	 * SEE PAGE 45/46 of Hitachi HD44780 spec FOR INITIALIZATION SPECIFICATION.
 	 * according to datasheet,we need at least 40ms after power rises above 2.7V
@@ -538,6 +597,8 @@ int rval = 0;
 		}
 	}
 #endif
+	_busyPoll = busypoll;
+	_qbuf = qbuf;
 	backlight(); // turn on the backlight, if supported
 
 	return(rval);
@@ -545,11 +606,69 @@ int rval = 0;
 
 int hd44780::clear()
 {
-	return(command(HD44780_CLEARDISPLAY));  // clear display, set cursor to 0,0
+int rval;
+
+	if(_fastClear && _shadow && !_shift && !_mqText && !_dblBuf
+	 && ((_displaymode & (HD44780_ENTRYLEFT2RIGHT|HD44780_ENTRYAUTOSHIFT)) == HD44780_ENTRYLEFT2RIGHT))
+	{
+	uint32_t cost = 0;
+	uint8_t run = 0;
+	// each byte takes the longer of its execution time and its transfer time
+	uint32_t bytecost = (_ioXferTime > _insExecTime) ? _ioXferTime : _insExecTime;
+
+		// blank the shadow buffer and estimate the time it takes
+		// flushShadow() to send the characters that changed.
+		// characters outside the display area are not erased.
+		for(int idx = 0; idx < _cols * _rows; idx++)
+		{
+			if(_shadow[idx] != ' ')
+			{
+				_shadow[idx] = ' ';
+				shadowDirty()[idx/8] |= (1 << (idx%8));
+			}
+			if(shadowIsDirty(idx))
+			{
+				if(!run || !(idx % _cols))
+					cost += bytecost; // set address for the run
+				cost += bytecost;
+				run = 1;
+			}
+			else
+			{
+				run = 0;
+			}
+		}
+
+		if(cost < _chExecTime)
+		{
+			_curcol = 0;
+			_currow = 0;
+			return(RV_ENOERR);
+		}
+	}
+
+	rval = command(HD44780_CLEARDISPLAY);  // clear display, set cursor to 0,0
+	if(_shadow)
+		shadowReset(0); // LCD is now all spaces
+	return(rval);
 }
 
 int hd44780::home()
 {
+	// without a display shift, DDRAM address 0 is home and
+	// setting it executes much quicker than the home instruction
+	if(_fastClear && !_shift)
+	{
+		_curcol = 0;
+		_currow = 0;
+		if(_shadow)
+			return(RV_ENOERR); // LCD is updated by flushShadow()
+		if(_nctl > 1)
+			apiCtl(0);
+		if(_ddramAddr == 0)
+			return(RV_ENOERR);
+		return(command(HD44780_SETDDRAMADDR));
+	}
 	return(command(HD44780_RETURNHOME));  // set cursor position to 0,0
 }
 
@@ -609,6 +728,15 @@ int hd44780::setCursor(uint8_t col, uint8_t row)
 		_currow = row;
 	}
 
+	if(_shadow)
+	{
+		// only the shadow buffer cursor position moves
+		// the LCD is updated by flushShadow()
+		_curcol = col;
+		_currow = row;
+		return(RV_ENOERR);
+	}
+
 #ifdef later
 	// in right to left mode the cursor position wil be incorrect.
 	// however, things like home() and clear() will not work as expected either.
@@ -622,7 +750,37 @@ int hd44780::setCursor(uint8_t col, uint8_t row)
 		return(command(HD44780_SETDDRAMADDR | (_cols - col -1 + _rowOffsets[row])));
 	else
 #endif
-		return(command(HD44780_SETDDRAMADDR | (col + _rowOffsets[row])));
+	{
+	uint8_t addr;
+
+		// rows on a dual controller display belong to one of the controllers
+		if(_nctl > 1)
+			apiCtl(row >= _ctlRow);
+
+		// while doing a marquee, col is a visible column on the shifted display
+		// while double buffering, col is a column on the back page
+		if(_mqText)
+			addr = shiftAddr(col, row);
+		else if(_dblBuf)
+			addr = shiftAddr(col + lineLen()/2, row);
+		else
+			addr = (col + _rowOffsets[row]) & 0x7f;
+
+		// nothing to do if LCD address counter is already there
+		if(_ddramAddr == addr)
+			return(RV_ENOERR);
+
+		return(command(HD44780_SETDDRAMADDR | addr));
+	}
+}
+
+// shiftAddr() - DDRAM address of col,row on the shifted display
+uint8_t hd44780::shiftAddr(uint8_t col, uint8_t row)
+{
+uint8_t len = lineLen();
+uint8_t line = (len == 40) ? (_rowOffsets[row] & 0x40) : 0;
+
+	return(line + ((_rowOffsets[row] - line) + col + _shift) % len);
 }
 
 // turn off display pixels
@@ -726,29 +884,17 @@ int hd44780::noAutoscroll(void)
 // (location is bits 3-5 and data row is bits 0-2 of the instruction)
 int hd44780::createChar(uint8_t location, uint8_t charmap[])
 {
-int rval;
-int ddramaddr;
-
 	location &= 0x7; // we only have 8 locations 0-7
+	return(loadChars(location, 1, charmap, 0));
+}
 
-	ddramaddr = status(); // fetch status which includes ddram address
-
-	if(ddramaddr < 0) // status() failed, so just set address to 0
-		ddramaddr = 0;
-	else
-		ddramaddr &= 0x7f; // strip off BUSY bit
-
-	rval = command(HD44780_SETCGRAMADDR | (location << 3));
-	if(rval)
-		return(rval);
-	for (int i=0; i<8; i++)
-	{
-		if(_write(charmap[i]) != 1) // use raw write to avoid line processing
-			return(RV_EIO);
-	}
-
-	// put LCD back into DDRAM mode so write() works
-	return(setCursor(ddramaddr , 0));
+// createChars() - load multiple custom characters starting at location first
+// The CGRAM address is only set once and all the glyph data is sent as
+// a single bulk write.
+// returns 0 on success, non zero on failure
+int hd44780::createChars(uint8_t first, uint8_t count, uint8_t charmaps[][8])
+{
+	return(loadChars(first, count, &charmaps[0][0], 0));
 }
 
 // special version of code to support wimpy AVR parts that can't directly access
@@ -765,23 +911,89 @@ int ddramaddr;
 #if defined (PROGMEM)
 int hd44780::createChar(uint8_t location, const uint8_t *charmap)
 {
-uint8_t buf[8];
-	// fetch/read the full 8 byte glyph data into RAM
-	for(int i= 0; i< 8; i++)
-	{
-		buf[i] = pgm_read_byte(charmap++);
-	}
-	// call the RAM based function to actually send it to the LCD
-	return(createChar(location, buf));
+	location &= 0x7; // we only have 8 locations 0-7
+	return(loadChars(location, 1, charmap, 1));
+}
+int hd44780::createChars(uint8_t first, uint8_t count, const uint8_t charmaps[][8])
+{
+	return(loadChars(first, count, &charmaps[0][0], 1));
 }
 #else
 int hd44780::createChar(uint8_t location, const uint8_t *charmap)
 {
-	return(createChar(location, (uint8_t *)charmap));
+	location &= 0x7; // we only have 8 locations 0-7
+	return(loadChars(location, 1, charmap, 0));
+}
+int hd44780::createChars(uint8_t first, uint8_t count, const uint8_t charmaps[][8])
+{
+	return(loadChars(first, count, &charmaps[0][0], 0));
 }
 
 #endif
 
+// loadChars() - send custom character glyph data to CGRAM
+// progmem is nonzero if the glyph data must be read using pgm_read_byte()
+//
+// The DDRAM address is restored when done so that write() works
+// The tracked address is used when it is known to avoid reading the status.
+//
+// returns 0 on success, non zero on failure
+int hd44780::loadChars(uint8_t first, uint8_t count, const uint8_t *bitmaps, uint8_t progmem)
+{
+int rval;
+int ddramaddr;
+
+	if((first > 7) || (count > 8 - first))
+		return(RV_EINVAL);
+
+	if(_ddramAddr != 0xff)
+	{
+		ddramaddr = _ddramAddr; // use tracked address, no need to read it
+	}
+	else
+	{
+		ddramaddr = status(); // fetch status which includes ddram address
+
+		if(ddramaddr < 0) // status() failed, so just set address to 0
+			ddramaddr = 0;
+		else
+			ddramaddr &= 0x7f; // strip off BUSY bit
+	}
+
+	rval = command(HD44780_SETCGRAMADDR | (first << 3));
+	if(rval)
+		return(rval);
+
+	// use raw writes to avoid line processing
+#if defined (PROGMEM)
+	if(progmem)
+	{
+	uint8_t buf[8];
+		// fetch/read each 8 byte glyph into RAM and send it
+		while(count--)
+		{
+			for(int i= 0; i< 8; i++)
+			{
+				buf[i] = pgm_read_byte(bitmaps++);
+			}
+			if((rval = _writeBuf(buf, 8))) // intentional assignment
+				return(rval);
+		}
+	}
+	else
+#else
+	(void) progmem; // glyph data can be read directly
+#endif
+	{
+		if((rval = _writeBuf(bitmaps, count * 8))) // intentional assignment
+			return(rval);
+	}
+
+	// put LCD back into DDRAM mode so write() works
+	// (setCursor() is not used as it does line wrapping and shadow processing)
+	return(command(HD44780_SETDDRAMADDR | ddramaddr));
+}
+
 // turn on backlight at full intensity
 int hd44780::backlight(void)
 {
@@ -819,18 +1031,263 @@ inline int hd44780::command(uint8_t value)
 {
 int status;
 
-	status = iowrite(HD44780_IOcmd, value);
-
-	// executime time depends on command
 	if((value == HD44780_CLEARDISPLAY) || (value == HD44780_RETURNHOME))
 	{
 		_curcol = 0;
 		_currow = 0;
+	}
+	trackCommand(value);
+
+	if(_qbuf)
+		status = enqueue(HD44780_IOcmd, value);
+	else
+		status = iosend(HD44780_IOcmd, value, _ctlSel);
+
+	if(status)
+	{
+		// unknown if command did not complete
+		_ddramAddr = 0xff;
+		_ctlAddr[_ctlSel] = 0xff;
+	}
+	return(status);
+}
+
+// trackCommand() - update tracked LCD address counter and display shift for a command
+void hd44780::trackCommand(uint8_t value)
+{
+	if(value & HD44780_SETDDRAMADDR)
+	{
+		_ddramAddr = value & 0x7f;
+	}
+	else if(value & (HD44780_SETCGRAMADDR|HD44780_FUNCTIONSET))
+	{
+		// address counter is now for CGRAM or a function set
+		// may be used for special things like VFD brightness
+		_ddramAddr = 0xff;
+		_ctlAddr[0] = _ctlAddr[1] = _ddramAddr; // sent to both controllers
+	}
+	else if(value & HD44780_CURDISPSHIFT)
+	{
+		if(value & HD44780_DISPLAYMOVE)
+			trackShift(value & HD44780_MOVERIGHT, 1);
+		else
+			trackAddr(value & HD44780_MOVERIGHT, 1);
+	}
+	else if(value & HD44780_DISPLAYCONTROL)
+	{
+		// no change
+	}
+	else if(value & HD44780_ENTRYMODESET)
+	{
+		_entryMode = value & (HD44780_ENTRYLEFT2RIGHT|HD44780_ENTRYAUTOSHIFT);
+	}
+	else if(value & HD44780_RETURNHOME)
+	{
+		_ddramAddr = 0;
+		_ctlAddr[0] = _ctlAddr[1] = _ddramAddr; // sent to both controllers
+		_shift = 0;
+		_mqText = 0; // a marquee can't continue once the shift is reset
+	}
+	else if(value & HD44780_CLEARDISPLAY)
+	{
+		// clear also sets the entry mode to increment
+		_ddramAddr = 0;
+		_ctlAddr[0] = _ctlAddr[1] = _ddramAddr; // sent to both controllers
+		_shift = 0;
+		_entryMode |= HD44780_ENTRYLEFT2RIGHT;
+		_mqText = 0; // a marquee can't continue once the shift is reset
+	}
+}
+
+// trackData() - update tracked LCD address counter and display shift
+// for data read/writes
+void hd44780::trackData(size_t count)
+{
+	// autoshift shifts the display the opposite direction of the entry mode
+	if(_entryMode & HD44780_ENTRYAUTOSHIFT)
+		trackShift(!(_entryMode & HD44780_ENTRYLEFT2RIGHT), count);
+	trackAddr(_entryMode & HD44780_ENTRYLEFT2RIGHT, count);
+}
+
+// trackAddr() - move tracked LCD address counter count positions
+// The address counter wraps between lines the same way the LCD does.
+// An invalid DDRAM address makes the address unknown.
+void hd44780::trackAddr(uint8_t inc, size_t count)
+{
+uint8_t line;	// address of start of line the address counter is in
+uint8_t len;	// length of line
+
+	if(_ddramAddr == 0xff)
+		return;
+
+	if(_displayfunction & HD44780_2LINE)
+	{
+		// two lines of 40 characters at 0x00 and 0x40
+		line = _ddramAddr & 0x40;
+		len = 40;
+	}
+	else
+	{
+		// one line of 80 characters
+		line = 0;
+		len = 80;
+	}
+
+	if((_ddramAddr - line) >= len)
+	{
+		_ddramAddr = 0xff; // not a valid DDRAM address
+		return;
+	}
+
+	while(count--)
+	{
+		if(inc)
+		{
+			if(++_ddramAddr == line + len)
+			{
+				if(len == 40)
+					line ^= 0x40; // wrap to other line
+				_ddramAddr = line;
+			}
+		}
+		else
+		{
+			if(_ddramAddr == line)
+			{
+				if(len == 40)
+					line ^= 0x40; // wrap to other line
+				_ddramAddr = line + len;
+			}
+			_ddramAddr--;
+		}
+	}
+}
+
+// trackShift() - update tracked display shift
+// _shift is the DDRAM line position shown in the first column
+// shifting the display left moves the DDRAM line to the left.
+void hd44780::trackShift(uint8_t right, size_t count)
+{
+uint8_t len = lineLen();
+
+	count %= len;
+	if(right)
+		count = len - count;
+	_shift = (_shift + count) % len;
+}
+
+// iosend() - send a command or data byte to controller ctl
+//
+// On dual controller displays, commands that are not for a specific
+// location are sent to both controllers, as is data when the CGRAM is being
+// accessed. The other controller is sent the command first so both
+// controllers execute it at the same time.
+// The cursor is only shown on the controller being accessed.
+//
+// Returns 0 on success, non zero on failure
+//
+int hd44780::iosend(hd44780::iotype type, uint8_t value, uint8_t ctl)
+{
+uint8_t both;
+int status;
+
+	if(_nctl < 2)
+		return(ctlsend(type, value));
+
+	if(type == HD44780_IOcmd)
+	{
+		if(value & HD44780_SETDDRAMADDR)
+		{
+			_cgram = 0;
+			both = 0;
+		}
+		else if((value & (HD44780_SETCGRAMADDR|HD44780_FUNCTIONSET|HD44780_CURDISPSHIFT|HD44780_DISPLAYMOVE)) == HD44780_CURDISPSHIFT)
+		{
+			both = 0; // cursor move
+		}
+		else
+		{
+			if(value & HD44780_SETCGRAMADDR)
+				_cgram = 1;
+			else if(value < HD44780_ENTRYMODESET)
+				_cgram = 0; // clear or home
+			both = 1;
+		}
+	}
+	else
+	{
+		both = _cgram;
+	}
+
+	if(both)
+	{
+		selectCtl(!ctl);
+		if((type == HD44780_IOcmd) && ((value & ~(HD44780_DISPLAYON|HD44780_CURSORON|HD44780_BLINKON)) == HD44780_DISPLAYCONTROL))
+			status = ctlsend(type, value & ~(HD44780_CURSORON|HD44780_BLINKON));
+		else
+			status = ctlsend(type, value);
+		if(status)
+			return(status);
+	}
+	selectCtl(ctl);
+	return(ctlsend(type, value));
+}
+
+// selectCtl() - select controller used by the i/o class
+// Each controller has its own execution time tracking.
+void hd44780::selectCtl(uint8_t ctl)
+{
+uint8_t curs = _displaycontrol & (HD44780_CURSORON|HD44780_BLINKON);
+
+	if(ctl == _ctl)
+		return;
+
+	// move visible cursor to the other controller
+	if(curs)
+		ctlsend(HD44780_IOcmd, HD44780_DISPLAYCONTROL | (_displaycontrol & ~curs));
+
+	_ctlStart[_ctl] = _startTime;
+	_ctlExec[_ctl] = _execTime;
+	_ctl = ctl;
+	_startTime = _ctlStart[_ctl];
+	_execTime = _ctlExec[_ctl];
+
+	if(curs)
+		ctlsend(HD44780_IOcmd, HD44780_DISPLAYCONTROL | _displaycontrol);
+}
+
+// apiCtl() - select controller for API functions
+// Each controller has its own tracked address counter.
+void hd44780::apiCtl(uint8_t ctl)
+{
+	if(ctl == _ctlSel)
+		return;
+	_ctlAddr[_ctlSel] = _ddramAddr;
+	_ctlSel = ctl;
+	_ddramAddr = _ctlAddr[_ctlSel];
+}
+
+// ctlsend() - send a command or data byte to the lcd using the i/o class
+// and mark the start of its execution time
+//
+// Returns 0 on success, non zero on failure
+//
+int hd44780::ctlsend(hd44780::iotype type, uint8_t value)
+{
+int status;
+
+	pollReady();
+	status = iowrite(type, value);
+
+	// executime time depends on command
+	if((type == HD44780_IOcmd) &&
+	  ((value == HD44780_CLEARDISPLAY) || (value == HD44780_RETURNHOME)))
+	{
 		markStart(_chExecTime);
 	}
 	else
 	{
-		markStart(_insExecTime);
+		markIns();
 	}
 
 	return(status);
@@ -842,7 +1299,11 @@ int status;
 //	failure: neagative value (error or read/status not supported by i/o subclass
 int hd44780::status()
 {
-int rvalue = ioread(HD44780_IOcmd);
+int rvalue;
+
+	flushQueue(); // status must be read after queued commands are done
+	selectCtl(_ctlSel);
+	rvalue = ioread(HD44780_IOcmd);
 	// markStart() is not called here as status reads do not
 	// require any execution time.
 	// setting the start time to now, which is 0, can potentially erase
@@ -857,16 +1318,51 @@ int rvalue = ioread(HD44780_IOcmd);
 //	failure: neagative value (error or read not supported by i/o subclass
 int hd44780::read()
 {
-int rvalue = ioread(HD44780_IOdata);
+int rvalue;
+
+	flushQueue(); // data must be read after queued commands are done
+	selectCtl(_ctlSel);
+	pollReady();
+	rvalue = ioread(HD44780_IOdata);
+	if(rvalue < 0)
+		_ddramAddr = 0xff; // unknown if read did not complete
+	else
+		trackData(1); // reads move the address counter like writes
 	// it apears that even though the read operation actually completed
 	// when the data has been read, i.e. ioread() returns,
 	// that the chip cannot take another instruction
 	// until after the normal instruction execution time.
 	// See Table 6 page 25 of Hitachi hd44780 datasheet
-	markStart(_insExecTime);
+	markIns();
 	return(rvalue);
 }
 
+// readBuf() - read consecutive data bytes from LCD
+// reads len bytes starting at the current address, like calling read()
+// len times but allows the i/o class to do the reads together.
+// returns:
+// 	success: number of bytes read
+//	failure: neagative value (error or read not supported by i/o subclass
+int hd44780::readBuf(uint8_t *buf, size_t len)
+{
+int status;
+
+	if(!len)
+		return(0);
+	flushQueue(); // data must be read after queued commands are done
+	selectCtl(_ctlSel);
+	pollReady();
+	status = ioreadBuf(HD44780_IOdata, buf, len);
+	if(status < 0)
+		_ddramAddr = 0xff; // unknown if read did not complete
+	else
+		trackData(len);
+	markIns();
+	if(status < 0)
+		return(status);
+	return((int) len);
+}
+
 // write() - process data character byte to lcd
 // returns number of bytes successfully written to device
 // i.e. 1 if success or 0 if no character was processed (error)
@@ -874,7 +1370,28 @@ size_t hd44780::write(uint8_t value)
 {
 size_t rval;
 
-	rval = _write(value);
+	if(_shadow)
+	{
+		// update shadow buffer, characters beyond the display are dropped
+		if((_curcol < _cols) && (_currow < _rows))
+		{
+		int idx = _currow * _cols + _curcol;
+
+			if(_shadow[idx] != value)
+			{
+				_shadow[idx] = value;
+				shadowDirty()[idx/8] |= (1 << (idx%8));
+			}
+			if(!_wraplines)
+				_curcol++;
+		}
+		rval = 1;
+	}
+	else
+	{
+		rval = _write(value);
+	}
+
 	if(_wraplines)
 	{
 		// currently only works for left to right mode
@@ -890,6 +1407,587 @@ size_t rval;
 	return (rval);
 }
 
+// write() - process a buffer of data characters to the lcd
+// returns number of bytes successfully written to device
+//
+// Characters are handed to the i/o class in runs using iowriteBuf()
+// which allows i/o classes to send multiple characters per transfer.
+// Runs are split at the end of each line when doing line wrapping.
+size_t hd44780::write(const uint8_t *buffer, size_t size)
+{
+size_t n = 0;
+size_t len;
+
+	// shadow buffer updates are done a character at a time
+	if(_shadow)
+	{
+		while(n < size)
+			n += write(buffer[n]);
+		return(n);
+	}
+
+	// line wrapping needs the geometry from begin()
+	if(_wraplines && !_cols)
+		return(0);
+
+	while(n < size)
+	{
+		len = size - n;
+		if(_wraplines && (len > (size_t) (_cols - _curcol)))
+			len = _cols - _curcol;
+
+		if(_writeBuf(buffer + n, len))
+			break;
+		n += len;
+
+		if(_wraplines)
+		{
+			// currently only works for left to right mode
+			_curcol += len;
+			if(_curcol >= _cols)
+			{
+				_curcol = 0;
+				_currow++;
+				if(_currow >= _rows)
+					_currow = 0;
+				setCursor(_curcol, _currow);
+			}
+		}
+	}
+	return(n);
+}
+
+
+// queueBuffer() - queue commands and data in a buffer
+// buf must be at least HD44780_QUEUESIZE(entries) bytes and can hold
+// up to 255 entries.
+// Once enabled, commands and data are queued and sent to the LCD by poll()
+// which sends queued entries as the LCD execution times allow.
+// poll() can be called from loop() or from a timer ISR.
+// NOTE: poll() from an ISR is only safe with i/o classes that don't use
+// the Wire library, like hd44780_pinIO. With i2c i/o classes it would do
+// Wire transfers inside the ISR, which collide with main line i/o such
+// as setBacklight(), so call poll() from loop() instead.
+// If the queue fills up, entries are sent until there is space in the queue.
+// Functions that read from the LCD send all queued entries before reading.
+int hd44780::queueBuffer(uint8_t *buf, size_t size)
+{
+	if(!buf || (size < (size_t) HD44780_QUEUESIZE(2)))
+		return(RV_EINVAL);
+
+	flushQueue();
+	_qsize = 0;
+	_qbuf = 0;
+	_qhead = 0;
+	_qtail = 0;
+	_qbusy = 0;
+	_qstatus = RV_ENOERR;
+	if(size > HD44780_QUEUESIZE(255))
+		size = HD44780_QUEUESIZE(255);
+	_qsize = size / HD44780_QUEUESIZE(1);
+	_qbuf = buf;
+	return(RV_ENOERR);
+}
+
+// noQueueBuffer() - send all queued entries and stop queuing
+int hd44780::noQueueBuffer()
+{
+int rval = flushQueue();
+
+	_qbuf = 0;
+	return(rval);
+}
+
+// poll() - send queued entries to the LCD that can be sent without waiting
+// returns:
+//	success: number of entries still in the queue
+//	failure: negative value if sending a queued entry failed
+//	(the error is reported once)
+int hd44780::poll()
+{
+int rval;
+
+	if(!_qbuf || _qbusy) // nothing to do or already sending entries
+		return(queued());
+
+	_qbusy = 1;
+	while((_qtail != _qhead) && ready())
+		dequeue();
+	_qbusy = 0;
+
+	if((rval = _qstatus)) // intentional assignment
+	{
+		_qstatus = RV_ENOERR;
+		return(rval);
+	}
+	return(queued());
+}
+
+// flushQueue() - send all queued entries to the LCD
+// returns 0 on success, non zero if sending a queued entry failed
+int hd44780::flushQueue()
+{
+int rval;
+
+	if(!_qbuf)
+		return(RV_ENOERR);
+
+	// main line code is never running while an ISR is in poll()
+	// so there is no need to wait for an ISR to finish
+	_qbusy = 1;
+	while(_qtail != _qhead)
+		dequeue();
+	_qbusy = 0;
+
+	rval = _qstatus;
+	_qstatus = RV_ENOERR;
+	return(rval);
+}
+
+// queued() - number of entries in the queue
+int hd44780::queued()
+{
+int n;
+
+	if(!_qbuf)
+		return(0);
+	n = _qhead - _qtail;
+	if(n < 0)
+		n += _qsize;
+	return(n);
+}
+
+// enqueue() - add an entry to the queue, sending entries if the queue is full
+// returns 0 on success, non zero if sending a queued entry failed
+int hd44780::enqueue(hd44780::iotype type, uint8_t value)
+{
+uint8_t next = _qhead + 1;
+int rval = RV_ENOERR;
+
+	if(next >= _qsize)
+		next = 0;
+
+	// make room by sending the oldest entry
+	// _qbusy is set before looking at the queue so a poll() from an ISR
+	// can't empty the queue between the check and the dequeue()
+	_qbusy = 1;
+	if((next == _qtail) && (_qtail != _qhead))
+	{
+		dequeue();
+		rval = _qstatus;
+		_qstatus = RV_ENOERR;
+	}
+	_qbusy = 0;
+
+	_qbuf[2*_qhead] = type | (_ctlSel << 7);
+	_qbuf[2*_qhead+1] = value;
+	_qhead = next; // update head last so poll() from an ISR sees a complete entry
+	return(rval);
+}
+
+// dequeue() - send the oldest queued entry
+// errors are saved in _qstatus
+void hd44780::dequeue()
+{
+uint8_t tail = _qtail;
+int rval;
+
+	// bit 7 of the type is the controller
+	rval = iosend((hd44780::iotype) (_qbuf[2*tail] & 0x7f), _qbuf[2*tail+1], _qbuf[2*tail] >> 7);
+	if(rval)
+		_qstatus = rval;
+	if(++tail >= _qsize)
+		tail = 0;
+	_qtail = tail;
+}
+
+// marquee() - scroll text across a row using the hardware display shift
+//
+// The text is loaded into the full DDRAM line of the row, including the
+// off screen columns, and each marqueeStep() scrolls the display one
+// column to the left with a single command.
+// Off screen columns are refilled with upcoming text one column per step:
+// the column that just scrolled off the left is rewritten with the text
+// it will show when it comes back on the right, so each step is the shift
+// command plus at most one address command and one data byte.
+// Text that fits in the off screen part of the DDRAM line along with a
+// display width of spacing never needs refilling.
+//
+// The display shift moves all rows, so other rows will scroll as well.
+// While a marquee is running, setCursor() positions are visible
+// columns on the shifted display.
+// clear(), home(), and noMarquee() end the marquee.
+// The text is not copied so it must remain valid during the marquee.
+//
+// Requires left to right mode with no autoscroll, no shadow buffer,
+// and that the row is the only row in its DDRAM line.
+//
+// returns 0 on success, non zero on failure
+int hd44780::marquee(uint8_t row, const char *text)
+{
+uint8_t len = lineLen();
+
+	if(!text || (row >= _rows))
+		return(RV_EINVAL);
+
+	if(_shadow || _dblBuf || (_entryMode != HD44780_ENTRYLEFT2RIGHT) || (_cols >= len))
+		return(RV_ENOTSUP);
+
+	// the marquee uses the full DDRAM line
+	if(lineShared(row))
+		return(RV_ENOTSUP);
+
+	_mqText = text;
+	_mqLen = strlen(text);
+	_mqPeriod = _mqLen + _cols; // text followed by a display width of spaces
+	if(_mqPeriod < len)
+		_mqPeriod = len; // pad to DDRAM line length so no refilling is needed
+	_mqPos = 0;
+	_mqRow = row;
+
+	return(marqueeFill(0, len));
+}
+
+// marqueeStep() - scroll the marquee one column to the left
+// returns 0 on success, non zero on failure
+int hd44780::marqueeStep()
+{
+uint8_t len = lineLen();
+int rval;
+
+	if(!_mqText)
+		return(RV_ENOTSUP);
+
+	if((rval = scrollDisplayLeft())) // intentional assignment
+		return(rval);
+
+	if(++_mqPos >= _mqPeriod)
+		_mqPos = 0;
+
+	// refill the column that just scrolled off the left,
+	// which is the last column of the DDRAM line on the shifted display.
+	// Consecutive refills are at consecutive addresses so the address
+	// only needs to be set after something else moved the address counter.
+	if(_mqPeriod != len)
+		return(marqueeFill(len - 1, 1));
+	return(RV_ENOERR);
+}
+
+// noMarquee() - end a marquee and remove the display shift
+int hd44780::noMarquee()
+{
+	_mqText = 0;
+	return(home());
+}
+
+// doubleBuffer() - draw on a hidden page and flip() to show it
+//
+// Each DDRAM line is split into two pages, the front page is shown
+// and the back page is in the hidden part of the DDRAM line.
+// While double buffering, setCursor() positions are on the back page.
+// flip() shows the back page by shifting the display half a DDRAM line
+// which swaps the front and back pages without re-drawing any characters.
+// The hd44780 can only shift the display one position per instruction,
+// so a flip is lineLen()/2 (20) shift instructions and the pages visibly
+// slide when the instructions are slow to send.
+// e.g. about 0.8ms using pins, about 10ms using i2c at 100kHz.
+//
+// Requires no shadow buffer or marquee, each row must be the only
+// row in its DDRAM line and cols must fit in half a DDRAM line.
+// e.g. 16x2 and 20x2 work, 20x4 and 40x2 do not.
+//
+// The display shift is reset, so page 0 is the front page.
+//
+// returns 0 on success, non zero on failure
+int hd44780::doubleBuffer()
+{
+	if(!_cols) // begin() has not been called
+		return(RV_EINVAL);
+
+	if(_shadow || _mqText || (_cols > lineLen()/2))
+		return(RV_ENOTSUP);
+
+	for(uint8_t r = 0; r < _rows; r++)
+	{
+		if(lineShared(r))
+			return(RV_ENOTSUP);
+	}
+
+	_dblBuf = 1;
+	if(_shift)
+		return(home());
+	return(RV_ENOERR);
+}
+
+// noDoubleBuffer() - stop double buffering and remove the display shift
+// Since page 0 will be shown, the display should be re-drawn.
+int hd44780::noDoubleBuffer()
+{
+	_dblBuf = 0;
+	return(home());
+}
+
+// flip() - show the back page
+// This is done using display shift commands, one per column of
+// half a DDRAM line.
+// returns 0 on success, non zero on failure
+int hd44780::flip()
+{
+int rval;
+
+	if(!_dblBuf)
+		return(RV_ENOTSUP);
+
+	for(uint8_t i = 0; i < lineLen()/2; i++)
+	{
+		if((rval = scrollDisplayLeft())) // intentional assignment
+			return(rval);
+	}
+	return(RV_ENOERR);
+}
+
+// lineShared() - check if another row uses the same DDRAM line as row
+// returns nonzero if the DDRAM line is shared
+uint8_t hd44780::lineShared(uint8_t row)
+{
+	for(uint8_t r = 0; r < _rows; r++)
+	{
+		if((r != row) && ((lineLen() == 80) || !((_rowOffsets[r] ^ _rowOffsets[row]) & 0x40)))
+			return(1);
+	}
+	return(0);
+}
+
+// marqueeFill() - write marquee text to count columns starting at col
+// col is a visible column on the shifted display
+int hd44780::marqueeFill(uint8_t col, uint8_t count)
+{
+uint8_t addr;
+uint16_t k;
+int rval;
+
+	if(_nctl > 1)
+		apiCtl(_mqRow >= _ctlRow);
+
+	while(count--)
+	{
+		addr = shiftAddr(col, _mqRow);
+		if(_ddramAddr != addr)
+		{
+			if((rval = command(HD44780_SETDDRAMADDR | addr))) // intentional assignment
+				return(rval);
+		}
+		k = (_mqPos + col) % _mqPeriod;
+		if(_write(k < _mqLen ? (uint8_t) _mqText[k] : ' ') != 1)
+			return(RV_EIO);
+		col++;
+	}
+	return(RV_ENOERR);
+}
+
+// shadowBuffer() - use a shadow DDRAM buffer
+// buf must be at least HD44780_SHADOWSIZE(cols, rows) bytes.
+// Once enabled, write() and setCursor() only update the buffer
+// and flushShadow() must be called to update the LCD.
+// Since the LCD contents are not known, the first flushShadow() will
+// re-draw the full display.
+// Can't be used while a marquee or double buffering is active
+// since those show the text by shifting the display.
+int hd44780::shadowBuffer(uint8_t *buf, size_t size)
+{
+	if(_dblBuf || _mqText)
+		return(RV_EINVAL);
+
+	if(!buf || (size < (size_t) HD44780_SHADOWSIZE(_cols, _rows)))
+		return(RV_EINVAL);
+
+	_shadow = buf;
+	_shadowSize = size;
+	shadowReset(1);
+	_curcol = 0;
+	_currow = 0;
+	return(RV_ENOERR);
+}
+
+// shadowReset() - fill shadow buffer with spaces and set all dirty bits
+void hd44780::shadowReset(uint8_t dirty)
+{
+	memset(_shadow, ' ', _cols * _rows);
+	memset(shadowDirty(), dirty ? 0xff : 0, (_cols * _rows + 7)/8);
+}
+
+// flushShadow() - send changed characters in the shadow buffer to the LCD
+//
+// Characters are sent in DDRAM address order and SETDDRAMADDR is only sent
+// when the LCD address counter is not already pointing to the next changed
+// character.
+// Small gaps of unchanged characters on a row are re-sent when that
+// is cheaper on the i/o interface than setting the address. (see ioaddrCost())
+//
+// Requires left to right mode with no autoscroll.
+//
+// returns 0 on success, non zero on failure
+int hd44780::flushShadow()
+{
+uint8_t order[sizeof(_rowOffsets)];	// rows in DDRAM address order
+uint8_t *dirty;
+uint8_t ac = _ddramAddr; // LCD address counter, 0xff is unknown
+uint8_t addr;
+uint8_t gapmax;
+int rval;
+
+	if(!_shadow)
+		return(RV_ENOTSUP);
+
+	if((_displaymode & (HD44780_ENTRYLEFT2RIGHT|HD44780_ENTRYAUTOSHIFT)) != HD44780_ENTRYLEFT2RIGHT)
+		return(RV_ENOTSUP);
+
+	if(_nctl > 1)
+		return(flushShadow2());
+
+	dirty = shadowDirty();
+	gapmax = ioaddrCost();
+
+	// sort rows by DDRAM address so rows that are next to each other
+	// in DDRAM (like rows 0 and 2 on a 20x4) can be sent without
+	// setting the address in between.
+	for(uint8_t i = 0; i < _rows; i++)
+	{
+	uint8_t j = i;
+		while(j && (_rowOffsets[order[j-1]] > _rowOffsets[i]))
+		{
+			order[j] = order[j-1];
+			j--;
+		}
+		order[j] = i;
+	}
+
+	for(uint8_t i = 0; i < _rows; i++)
+	{
+	uint8_t row = order[i];
+	int idx = row * _cols;
+	uint8_t start, end;
+
+		for(uint8_t col = 0; col < _cols; col++)
+		{
+			if(!shadowIsDirty(idx + col))
+				continue;
+
+			addr = _rowOffsets[row] + col;
+			start = col;
+			if(ac != addr)
+			{
+				if((ac < addr) && (ac >= _rowOffsets[row]) && ((addr - ac) <= gapmax))
+				{
+					// re-send the unchanged characters in the gap
+					start = ac - _rowOffsets[row];
+				}
+				else
+				{
+					if((rval = command(HD44780_SETDDRAMADDR | addr))) // intentional assignment
+						return(rval);
+				}
+			}
+
+			// extend the run over changed characters and small gaps
+			end = col + 1;
+			for(uint8_t c = end; c < _cols; c++)
+			{
+				if(shadowIsDirty(idx + c))
+					end = c + 1;
+				else if((c + 1 - end) > gapmax)
+					break;
+			}
+
+			if((rval = _writeBuf(&_shadow[idx + start], end - start))) // intentional assignment
+				return(rval);
+
+			for(uint8_t c = start; c < end; c++)
+				dirty[(idx+c)/8] &= ~(1 << ((idx+c)%8));
+
+			ac = _rowOffsets[row] + end;
+			col = end - 1;
+		}
+	}
+
+	// move the LCD cursor to the shadow cursor position when it can be seen
+	if((_displaycontrol & (HD44780_CURSORON|HD44780_BLINKON)) && (_currow < _rows))
+	{
+		addr = _rowOffsets[_currow] + _curcol;
+		if(ac != addr)
+			return(command(HD44780_SETDDRAMADDR | addr));
+	}
+	return(RV_ENOERR);
+}
+
+// flushShadow2() - flushShadow() for dual controller displays
+//
+// Changed characters are sent alternating between the two controllers
+// so each controller executes its write while the other one is being
+// sent a character.
+// Each controller gets its characters in DDRAM address order.
+//
+// returns 0 on success, non zero on failure
+int hd44780::flushShadow2()
+{
+int next[2];	// next shadow index for each controller, -1 when done
+uint8_t alt;
+uint8_t c;
+uint8_t row;
+uint8_t addr;
+int idx;
+int rval;
+
+	// when the cursor can be seen, it would have to be moved between the
+	// controllers each time so do one controller at a time instead.
+	alt = !(_displaycontrol & (HD44780_CURSORON|HD44780_BLINKON));
+
+	next[0] = next[1] = 0;
+	c = 0;
+	while((next[0] >= 0) || (next[1] >= 0))
+	{
+		if(next[c] >= 0)
+		{
+			// find next changed character on this controller
+			for(idx = next[c]; idx < _cols * _rows; idx++)
+			{
+				row = idx / _cols;
+				if(((row >= _ctlRow) == c) && shadowIsDirty(idx))
+					break;
+			}
+			if(idx < _cols * _rows)
+			{
+				next[c] = idx + 1;
+				apiCtl(c);
+				addr = (idx % _cols + _rowOffsets[row]) & 0x7f;
+				if(_ddramAddr != addr)
+				{
+					if((rval = command(HD44780_SETDDRAMADDR | addr))) // intentional assignment
+						return(rval);
+				}
+				if(_write(_shadow[idx]) != 1)
+					return(RV_EIO);
+				shadowDirty()[idx/8] &= ~(1 << (idx%8));
+			}
+			else
+			{
+				next[c] = -1;
+			}
+		}
+		if(alt || (next[c] < 0))
+			c = !c;
+	}
+
+	// move the LCD cursor to the shadow cursor position when it can be seen
+	if(!alt && (_currow < _rows))
+	{
+		apiCtl(_currow >= _ctlRow);
+		addr = (_curcol + _rowOffsets[_currow]) & 0x7f;
+		if(_ddramAddr != addr)
+			return(command(HD44780_SETDDRAMADDR | addr));
+	}
+	return(RV_ENOERR);
+}
 
 // _write() - send raw data byte to lcd
 // returns 1 if success or 0 if no byte was processed (error)
@@ -897,13 +1995,289 @@ size_t hd44780::_write(uint8_t value)
 {
 int status = 1; //assume success
 
-	if(iowrite(HD44780_IOdata, value))
+	if(_qbuf)
+	{
+		if(enqueue(HD44780_IOdata, value))
+			status = 0; // write was unsuccessful
+	}
+	else if(iosend(HD44780_IOdata, value, _ctlSel))
+	{
 		status = 0; // write was unsuccessful
-	markStart(_insExecTime);
+	}
+	if(status)
+		trackData(1);
+	else
+		_ddramAddr = 0xff;
 	
 	return status;
 }
 
+// _writeBuf() - send raw data bytes to lcd
+// returns 0 on success, non zero on failure
+int hd44780::_writeBuf(const uint8_t *buf, size_t len)
+{
+int status;
+
+	if(_qbuf)
+	{
+		for(size_t i = 0; i < len; i++)
+		{
+			if((status = enqueue(HD44780_IOdata, buf[i]))) // intentional assignment
+			{
+				_ddramAddr = 0xff;
+				return(status);
+			}
+		}
+		trackData(len);
+		return(RV_ENOERR);
+	}
+
+	// CGRAM data goes to both controllers
+	if(_cgram && (_nctl > 1))
+	{
+		selectCtl(!_ctlSel);
+		pollReady();
+		if((status = iowriteBuf(HD44780_IOdata, buf, len))) // intentional assignment
+		{
+			_ddramAddr = 0xff;
+			return(status);
+		}
+		markIns();
+	}
+
+	selectCtl(_ctlSel);
+	pollReady();
+	status = iowriteBuf(HD44780_IOdata, buf, len);
+	markIns();
+	if(status)
+		_ddramAddr = 0xff;
+	else
+		trackData(len);
+	return(status);
+}
+
+// iowriteBuf() - default multiple byte write for i/o classes
+// that don't have a way to send multiple bytes in a single transfer
+// returns 0 on success, non zero on failure
+int hd44780::iowriteBuf(hd44780::iotype type, const uint8_t *buf, size_t len)
+{
+int status;
+
+	while(len--)
+	{
+		if((status = iowrite(type, *buf++))) // intentional assignment
+			return(status);
+		markIns();
+		if(len)
+			pollReady();
+	}
+	return(RV_ENOERR);
+}
+
+// ioreadBuf() - default multiple byte read for i/o classes
+// that don't have a way to read multiple bytes together
+// returns 0 on success, negative value on failure
+int hd44780::ioreadBuf(hd44780::iotype type, uint8_t *buf, size_t len)
+{
+int rvalue;
+
+	while(len--)
+	{
+		if((rvalue = ioread(type)) < 0) // intentional assignment
+			return(rvalue);
+		*buf++ = rvalue;
+		markIns();
+		if(len)
+			pollReady();
+	}
+	return(RV_ENOERR);
+}
+
+// busyPoll() - poll the busy flag rather than doing timed waits
+// returns 0 on success, RV_ENOTSUP if status reads are not supported
+int hd44780::busyPoll()
+{
+	if(status() < 0)
+		return(RV_ENOTSUP);
+	_busyPoll = 1;
+	return(RV_ENOERR);
+}
+
+// calibrateExecTimes() - set execution times from measurements
+//
+// Times clear, home, set DDRAM address, and data write instructions
+// using the busy flag over several samples and sets the execution times
+// to the slowest measured time plus a safety margin of marginPct percent.
+// Times are measured from when iowrite() returns, just like markStart(),
+// and include the time of the status read that saw the LCD was ready.
+// If the LCD is already ready on the first status read, the status
+// read is slower than the instruction so the measured time
+// is limited to the current execution time.
+//
+// The display is cleared and the cursor is set to 0,0
+// If using a shadow buffer, the next flushShadow() will re-draw the display.
+//
+// returns 0 on success, non zero on failure
+// On failure the execution times are not changed.
+int hd44780::calibrateExecTimes(uint8_t marginPct)
+{
+uint32_t chexectime = 0;
+uint32_t insexectime = 0;
+int32_t us;
+
+	flushQueue(); // measurements bypass the queue
+	_ddramAddr = 0xff; // measurements bypass address tracking
+
+	for(uint8_t i = 0; i < HD44780_CALSAMPLES; i++)
+	{
+		if((us = measureExecTime(HD44780_IOcmd, HD44780_SETDDRAMADDR, _insExecTime)) < 0)
+			return(us);
+		if((uint32_t) us > insexectime)
+			insexectime = us;
+
+		if((us = measureExecTime(HD44780_IOdata, ' ', _insExecTime)) < 0)
+			return(us);
+		if((uint32_t) us > insexectime)
+			insexectime = us;
+
+		if((us = measureExecTime(HD44780_IOcmd, HD44780_RETURNHOME, _chExecTime)) < 0)
+			return(us);
+		if((uint32_t) us > chexectime)
+			chexectime = us;
+
+		// clear is done last so the display is left cleared
+		if((us = measureExecTime(HD44780_IOcmd, HD44780_CLEARDISPLAY, _chExecTime)) < 0)
+			return(us);
+		if((uint32_t) us > chexectime)
+			chexectime = us;
+	}
+
+	setExecTimes(chexectime + (chexectime * marginPct)/100, insexectime + (insexectime * marginPct)/100);
+
+	// clear also sets the entry mode to increment
+	_displaymode |= HD44780_ENTRYLEFT2RIGHT;
+	_ddramAddr = 0;
+	_shift = 0;
+	_entryMode |= HD44780_ENTRYLEFT2RIGHT;
+	_curcol = 0;
+	_currow = 0;
+	if(_shadow)
+		memset(shadowDirty(), 0xff, (_cols * _rows + 7)/8);
+
+	return(RV_ENOERR);
+}
+
+// measureExecTime() - time an instruction using the busy flag
+// exectime is the current execution time for the instruction.
+// returns execution time in us or negative value on failure
+int32_t hd44780::measureExecTime(hd44780::iotype type, uint8_t value, uint32_t exectime)
+{
+uint32_t stime;
+uint32_t etime;
+uint8_t reads = 0;
+int lcdstatus;
+int status;
+
+	// wait for previous instruction using normal timed wait
+	_waitReady(_startTime, _execTime);
+	_execTime = 0; // so i/o class won't wait
+
+	status = iowrite(type, value);
+	markStart(exectime);
+	if(status)
+		return(status);
+
+	stime = _startTime;
+	_execTime = 0; // so ioread() won't wait
+	do
+	{
+		if((lcdstatus = ioread(HD44780_IOcmd)) < 0) // intentional assignment
+		{
+			markStart(exectime);
+			return(lcdstatus);
+		}
+		etime = (now() - stime) / _ticksPerUs;
+		reads++;
+
+		// give up on a LCD that stays busy for much longer than expected
+		if((lcdstatus & 0x80) && (etime > 10 * exectime))
+		{
+			markStart(exectime);
+			return(RV_EBUSY);
+		}
+	} while(lcdstatus & 0x80);
+
+	if((reads == 1) && (etime > exectime))
+		etime = exectime;
+
+	markStart(0); // LCD is ready
+	return((int32_t) etime);
+}
+
+// pollReady() - wait for LCD to be ready using the busy flag
+//
+// The busy flag is polled until it clears or the execution time has
+// elapsed, whichever is first, so a LCD with a stuck busy flag is
+// no slower than using timed waits.
+// Once ready, the execution time is cleared so that the waitReady() in the
+// i/o class will not wait.
+// If the status read fails, busy polling is disabled and the timed
+// wait is used.
+void hd44780::pollReady()
+{
+uint32_t exectime = _execTime;
+int lcdstatus;
+
+	if(!_busyPoll || !exectime)
+		return;
+
+	_execTime = 0; // so ioread() won't wait
+	do
+	{
+		lcdstatus = ioread(HD44780_IOcmd);
+		if(lcdstatus < 0)
+		{
+			// status reads failed, fall back to timed waits
+			_busyPoll = 0;
+			_execTime = exectime;
+			return;
+		}
+		if(!(lcdstatus & 0x80))
+			return;
+		if(_idlefunc)
+			_idlefunc();
+	} while((now() - _startTime) < exectime);
+}
+
+// setTimeSource() - set the time source used for execution times
+// timefunc must return a free running 32 bit count that has
+// ticksPerUs counts per microsecond. A cpu cycle counter or a raw
+// timer count can be much quicker to read than micros().
+// timefunc 0 uses micros()
+void hd44780::setTimeSource(uint32_t (*timefunc)(void), uint16_t ticksPerUs)
+{
+	// finish current execution time using the old time source
+	_waitReady(_startTime, _execTime);
+
+	if(!timefunc || !ticksPerUs)
+	{
+		timefunc = 0;
+		ticksPerUs = 1;
+	}
+#if defined(HD44780_DWT)
+	if(timefunc == cycleCount)
+	{
+		// start the DWT cycle counter
+		*(volatile uint32_t *)0xE000EDFCUL |= (1UL << 24);	// DEMCR TRCENA
+		*(volatile uint32_t *)0xE0001FB0UL = 0xC5ACCE55;	// DWT_LAR unlock (M7)
+		*(volatile uint32_t *)0xE0001000UL |= 1;	// DWT_CTRL CYCCNTENA
+	}
+#endif
+	_timefunc = timefunc;
+	_ticksPerUs = ticksPerUs;
+	markStart(0);
+}
+
 //============================================================================
 // A couple of functions that really shouldn't be here.
 // blinkLED() and fatalError()
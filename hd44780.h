@@ -85,6 +85,13 @@
 #define HD44780_VERSION		10302
 #define HD44780_VERSIONSTR	"1.3.2"
 
+// number of bytes needed for a shadow DDRAM buffer for a cols x rows display
+// (one byte per character plus one dirty bit per character)
+#define HD44780_SHADOWSIZE(cols, rows) ((cols)*(rows) + ((cols)*(rows)+7)/8)
+
+// size in bytes of a command queue buffer for a given number of entries
+#define HD44780_QUEUESIZE(entries) ((entries)*2)
+
 class hd44780 : public Print
 {
 public:
@@ -100,6 +107,8 @@ public:
 	// these can be overridden using setExecTimes(chUs, insUs)
 	static const int HD44780_CHEXECTIME = 2000; // time in us for clear&home
 	static const int HD44780_INSEXECTIME = 38;
+	static const int HD44780_CALSAMPLES = 4;	// samples per instruction for calibrateExecTimes()
+	static const int HD44780_CALMARGIN = 25;	// default calibrateExecTimes() safety margin in percent
 
 	// API return values
 	// 0 means successful, less than zero means unsuccessful
@@ -199,6 +208,8 @@ public:
 	inline size_t write(int value) { return(write((uint8_t)value)); }
 	inline size_t _write(unsigned int value) { return(_write((uint8_t)value)); }
 	inline size_t _write(int value) { return(_write((uint8_t)value)); }
+	// native bulk write, does char & line processing
+	size_t write(const uint8_t *buffer, size_t size);
 
 	using Print::write; // for other Print Class write() functions
 	int cursor();
@@ -342,15 +353,138 @@ public:
 	inline int createChar(uint8_t charval, const char charmap[]) // assumes PROGMEM
 		{ return(createChar(charval, (const uint8_t *) charmap)); }
 
+	// load count custom characters starting at charval first
+	// using a single CGRAM address command and bulk write
+	int createChars(uint8_t first, uint8_t count, uint8_t charmaps[][8]); // no PROGMEM
+	int createChars(uint8_t first, uint8_t count, const uint8_t charmaps[][8]); // assumes PROGMEM
+
 	int read(void);
+	// read len consecutive data bytes starting at the current address
+	int readBuf(uint8_t *buf, size_t len);
 	// enable automatic line wrapping (only works in left 2 right mode)
 	int lineWrap(void)  { if(_displaymode & HD44780_ENTRYLEFT2RIGHT) {_wraplines=1; return(RV_ENOERR);}else{return(RV_ENOTSUP);}}
 	// disable automatic line wrapping
 	int noLineWrap(void){ _wraplines=0; return(RV_ENOERR);};		// turn off automatic line wrapping
 
+	// shadow DDRAM buffer
+	// When enabled, write() and setCursor() only update the shadow buffer
+	// and flushShadow() sends the characters that changed to the LCD.
+	// buffer must be at least HD44780_SHADOWSIZE(cols, rows) bytes
+	int shadowBuffer(uint8_t *buf, size_t size);
+	int noShadowBuffer(void) { _shadow = 0; return(RV_ENOERR); }
+	// nonzero when a shadow buffer is being used
+	inline uint8_t shadowEnabled(void) { return(_shadow != 0); }
+	int flushShadow(void);		// send changed shadow characters to the LCD
+	void flush(void) { flushShadow(); } // Print class flush()
+
+	// fast clear/home
+	// When enabled, clear() with a shadow buffer only erases the characters
+	// that are not blank when that is quicker than the clear instruction,
+	// and home() sets the DDRAM address when the display is not shifted.
+	int fastClear(void) { _fastClear = 1; return(RV_ENOERR); }
+	int noFastClear(void) { _fastClear = 0; return(RV_ENOERR); }
+
+	// command queue
+	// When enabled, commands and data are queued in buf and sent by poll()
+	// buffer must be HD44780_QUEUESIZE(entries) bytes, (2-255 entries)
+	int queueBuffer(uint8_t *buf, size_t size);
+	int noQueueBuffer(void);	// send queued entries and stop queuing
+	int poll(void);				// send queued entries that don't require waiting
+	int flushQueue(void);		// send all queued entries
+	int queued(void);			// number of entries in the queue
+
+	// LCD ready status
+	// ready() returns nonzero if the LCD can accept a command or data without waiting
+	// readyInUs() returns the number of microseconds until the LCD is ready
+	inline int ready(void) { return(readyInUs() == 0); }
+	inline uint32_t readyInUs(void)
+	{
+	uint32_t elapsed = now() - _startTime;
+		return((elapsed >= _execTime) ? 0 : (_execTime - elapsed) / _ticksPerUs);
+	}
+
+	// idle callback
+	// idlefunc is called repeatedly while waiting for the LCD to be ready
+	// It must not call any lcd functions; use 0 to remove the callback.
+	inline void setIdleCallback(void (*idlefunc)(void)) { _idlefunc = idlefunc; }
+
+	// time source for execution time tracking
+	// timefunc must return a free running 32 bit count with ticksPerUs
+	// counts per microsecond, like a cpu cycle counter.
+	// use 0 for micros() which is the default
+	void setTimeSource(uint32_t (*timefunc)(void), uint16_t ticksPerUs);
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+	// cpu cycle counter time source, use F_CPU/1000000 ticks per us
+	// NOTE: the cpu clock rate must not be changed after setTimeSource()
+#define HD44780_CYCLECOUNT
+	static uint32_t cycleCount(void) { return(ESP.getCycleCount()); }
+#elif defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+	// Cortex-M3/M4/M7 DWT cycle counter, use F_CPU/1000000 ticks per us
+	// setTimeSource() starts the counter since it is off after reset.
+	// NOTE: the cpu clock rate must not be changed after setTimeSource()
+#define HD44780_CYCLECOUNT
+#define HD44780_DWT
+	static uint32_t cycleCount(void) { return(*(volatile uint32_t *)0xE0001004UL); } // DWT_CYCCNT
+#elif defined(__AVR__) && defined(TCNT1H)
+	// AVR 16 bit Timer1 time source
+	// The sketch must set up Timer1 to count up free running (normal mode)
+	// with a prescaler that gives at least 1 tick per us, like F_CPU/8:
+	//	TCCR1A = 0; TCCR1B = _BV(CS11);
+	// and use F_CPU/8000000 ticks per us.
+	// The 16 bit count is extended to 32 bits using the 16 bit delta from the
+	// previous read which is wrap safe as long as the count is read at least
+	// once per 65536 ticks. A longer time between reads only loses time,
+	// which can only cause extra waiting, never too little.
+	// Timer1 can not be used for other things like analogWrite() on its pins.
+#define HD44780_TIMER1COUNT
+	static uint32_t timer1Count(void)
+	{
+	static uint16_t last;
+	static uint32_t count;
+	uint16_t t = TCNT1;
+
+		count += (uint16_t) (t - last);
+		last = t;
+		return(count);
+	}
+#endif
+
+	// hardware scrolling marquee
+	// scrolls text on a row using the LCD display shift
+	int marquee(uint8_t row, const char *text);
+	int marqueeStep(void);	// scroll marquee one column to the left
+	int noMarquee(void);	// end marquee and remove the display shift
+
+	// hardware page flipping
+	// draw on a hidden page of DDRAM and flip() to show it
+	// flip() is 20 display shift instructions, which visibly slide
+	// the pages on slow interfaces like i2c
+	int doubleBuffer(void);
+	int noDoubleBuffer(void);	// stop double buffering and remove the display shift
+	int flip(void);				// show the back page
+	// page being shown, 0 or 1
+	inline uint8_t frontPage(void) { return(_shift >= lineLen()/2); }
+
+	// busy flag polling
+	// When enabled, the busy flag is polled before sending to the LCD
+	// rather than always waiting the full execution time.
+	// Requires an i/o class that supports status reads.
+	// returns zero on success, RV_ENOTSUP if status reads are not supported
+	int busyPoll(void);
+	int noBusyPoll(void) { _busyPoll = 0; return(RV_ENOERR); }
+
 	// set execution times for commmands to override defaults
 	inline void setExecTimes(uint32_t chExecTimeUs, uint32_t insExecTimeUs)
 		{ _chExecTime = chExecTimeUs; _insExecTime = insExecTimeUs;}
+	// get the execution times currently being used
+	inline void getExecTimes(uint32_t &chExecTimeUs, uint32_t &insExecTimeUs)
+		{ chExecTimeUs = _chExecTime; insExecTimeUs = _insExecTime;}
+
+	// measure execution times using the busy flag and set them with
+	// a safety margin of marginPct percent. Clears the display.
+	// Must be called after begin(), requires an i/o class that supports status reads.
+	// returns zero on success, non zero on failure
+	int calibrateExecTimes(uint8_t marginPct = HD44780_CALMARGIN);
 
 	// A few undocumented helper functions for the included examples
 	static int blinkLED(int blinks);		// blink a built in LED if possible
@@ -371,40 +505,171 @@ protected:
 	uint8_t _cols;
 	uint8_t _rows;
 
+	// dual controller displays like 40x4 have two hd44780 chips with
+	// separate E signals.
+	// i/o classes that support a 2nd E signal set _nctl to 2
+	// and use _ctl to select the E signal.
+	uint8_t _nctl;	// number of controllers (1 or 2)
+	uint8_t _ctl;	// controller being accessed by the i/o class (0 or 1)
+
+	// minimum time in us from the LCD strobe of one iowrite() to the LCD
+	// strobe of the next one, 0 if not known.
+	// i/o classes set this when the transfer time is known, like from
+	// the i2c bus clock rate. When it is longer than the instruction
+	// execution time there is no need to track or wait for instructions.
+	uint16_t _ioXferTime;
+
+	// optional i/o subclass function - send multiple bytes of the same type.
+	// The i/o class must honor the instruction execution time between bytes.
+	// The default sends each byte using iowrite(), i/o classes can use it
+	// when they can't send the bytes together.
+	virtual int iowriteBuf(hd44780::iotype type, const uint8_t *buf, size_t len);
+
+	// optional i/o subclass function - read multiple bytes of the same type.
+	// The i/o class must honor the instruction execution time between bytes.
+	// The default reads each byte using ioread(), i/o classes can use it
+	// to keep the LCD in read mode between bytes.
+	virtual int ioreadBuf(hd44780::iotype type, uint8_t *buf, size_t len);
+
 	// wait for lcd to be ready
 	inline void waitReady() {_waitReady((_startTime), _execTime);}
-	inline void waitReady(int32_t offsetUs) {_waitReady((_startTime+offsetUs), _execTime);}
+	inline void waitReady(int32_t offsetUs) {_waitReady((_startTime+usToTicks(offsetUs)), _execTime);}
 
 	inline void _waitReady(uint32_t _stime, uint32_t _etime)
-		{while(( ((uint32_t)micros()) - _stime) < _etime){}}
+		{if(_etime) while((now() - _stime) < _etime){if(_idlefunc) _idlefunc();}}
 
-private:
+	// current time and time conversion for the time source
+	inline uint32_t now(void) { return(_timefunc ? _timefunc() : (uint32_t) micros()); }
+	inline uint32_t usToTicks(uint32_t us) { return((_ticksPerUs == 1) ? us : us * _ticksPerUs); }
 
+	// character & line processing state
+	// used by front ends that do their own processing (see hd44780_fixed)
 	uint8_t _curcol;	// current LCD col if doing char & line processing
 	uint8_t _currow;	// current LCD row if doing char & line processing
 	uint8_t _wraplines;	// set to nonzero if wrapping long lines
 
+	// nonzero when write() & setCursor() go directly to the LCD
+	// (no shadow buffer, marquee, double buffering, or 2nd controller)
+	inline uint8_t directMode(void) {return(!_shadow && !_mqText && !_dblBuf && (_nctl < 2));}
+
+	// internal API function to send multiple data bytes with no char & line processing
+	int _writeBuf(const uint8_t *buf, size_t len);
+
+	// set LCD DDRAM address, nothing is sent if the LCD is already there
+	inline int setAddr(uint8_t addr)
+		{return((_ddramAddr == addr) ? (int) RV_ENOERR : command(HD44780_SETDDRAMADDR | addr));}
+
+	// nonzero when data can be sent by calling the i/o class iowrite()
+	// directly (see hd44780_static), dataSent() must be called after.
+	inline uint8_t directData(void) {return(directMode() && !_qbuf && !_busyPoll);}
+	// track is zero when the caller does not need the address counter tracked
+	// count is the number of bytes sent
+	inline void dataSent(int status, uint8_t track = 1, size_t count = 1)
+		{markIns(); if(status || !track) _ddramAddr = 0xff; else trackData(count);}
+private:
+
+	void initState(void);	// default state set by all the constructors
+
+	// shadow DDRAM buffer: _cols*_rows characters followed by dirty bits
+	uint8_t *_shadow;		// shadow buffer, NULL if not using a shadow buffer
+	size_t _shadowSize;		// size of shadow buffer
+	uint8_t _fastClear;		// set to nonzero to avoid clear/home instructions
+	inline uint8_t *shadowDirty() { return(_shadow + _cols * _rows); }
+	void shadowReset(uint8_t dirty);
+	inline uint8_t shadowIsDirty(int idx) { return(shadowDirty()[idx/8] & (1 << (idx%8))); }
+
 	// i/o subclass functions
 	virtual int ioinit() {return 0;}	// optional - successful if not implemented
 	virtual int ioread(hd44780::iotype type) {if(type) return(RV_ENOTSUP);else return(RV_ENOTSUP);}	// optional, return fail if not implemented
 	virtual int iowrite(hd44780::iotype type, uint8_t value)=0;// mandatory
 	virtual int iosetBacklight(uint8_t dimvalue){if(dimvalue) return(RV_ENOTSUP); else return(RV_ENOTSUP);}	// optional
 	virtual int iosetContrast(uint8_t contvalue){if(contvalue) return(RV_ENOTSUP); else return(RV_ENOTSUP);}// optional
+	// optional - number of data bytes that can be sent in the same amount
+	// of time as a SETDDRAMADDR command. Used by flushShadow() to decide
+	// whether to re-send unchanged characters rather than setting the address.
+	virtual uint8_t ioaddrCost() {return 1;}
 
 	uint8_t _rowOffsets[4]; // memory address of start of each row/line
 
 	// stuff for tracking execution times
-	inline void markStart(uint32_t exectime) { _startTime = (uint32_t) micros(); _execTime = exectime;}
+	inline void markStart(uint32_t exectime) { _startTime = now(); _execTime = usToTicks(exectime);}
+	// instruction or data byte was sent, there is nothing to wait for
+	// when the next i/o class transfer takes longer than the execution time
+	inline void markIns(void) { if(_ioXferTime >= _insExecTime) _execTime = 0; else markStart(_insExecTime);}
 	uint32_t _chExecTime;	// time in Us of execution time for clear/home
 	uint32_t _insExecTime;	// time in Us of execution time for instructions or data
 	uint32_t _startTime;	// 'start' time of last thing sent to LCD (cmd or data)
-	uint32_t _execTime;		// execution time in Us of last thing sent to LCD (cmd or data)
+	uint32_t _execTime;		// execution time in ticks of last thing sent to LCD (cmd or data)
+	uint32_t (*_timefunc)(void);	// time source, NULL for micros()
+	uint16_t _ticksPerUs;	// time source ticks per microsecond
+	void (*_idlefunc)(void);	// called while waiting for LCD, NULL if none
+	uint8_t _busyPoll;		// set to nonzero if polling busy flag
+	int iosend(hd44780::iotype type, uint8_t value, uint8_t ctl);
+	int ctlsend(hd44780::iotype type, uint8_t value);
+
+	// dual controller support
+	uint8_t _ctlSel;		// controller used by API functions
+	uint8_t _ctlRow;		// first row on 2nd controller
+	uint8_t _cgram;			// set while accessing CGRAM, data goes to both controllers
+	uint8_t _ctlAddr[2];	// tracked address counter for each controller
+	uint32_t _ctlStart[2];	// start time for each controller
+	uint32_t _ctlExec[2];	// execution time for each controller
+	void selectCtl(uint8_t ctl);
+	void apiCtl(uint8_t ctl);
+	int flushShadow2();
+
+	// LCD address counter tracking
+	uint8_t _ddramAddr;		// LCD DDRAM address counter, 0xff if unknown
+	uint8_t _entryMode;		// LCD entry mode (increment & autoshift)
+	uint8_t _shift;			// LCD display shift, DDRAM line position in first column
+	void trackCommand(uint8_t value);
+	void trackData(size_t count);
+	void trackAddr(uint8_t inc, size_t count);
+	void trackShift(uint8_t right, size_t count);
+	// length of a DDRAM line, 2 line mode has two 40 character lines
+	inline uint8_t lineLen() { return((_displayfunction & HD44780_2LINE) ? 40 : 80); }
+	uint8_t shiftAddr(uint8_t col, uint8_t row);
+
+	// marquee
+	const char *_mqText;	// marquee text, NULL if no marquee
+	uint16_t _mqLen;		// length of marquee text
+	uint16_t _mqPeriod;		// characters in a marquee cycle, text & spacing
+	uint16_t _mqPos;		// position in marquee cycle shown in first column
+	uint8_t _mqRow;			// marquee row
+	int marqueeFill(uint8_t col, uint8_t count);
+	uint8_t lineShared(uint8_t row);
+
+	uint8_t _dblBuf;		// set to nonzero if double buffering
+
+	int loadChars(uint8_t first, uint8_t count, const uint8_t *bitmaps, uint8_t progmem);
+
+	// command queue: pairs of iotype & value
+	uint8_t *_qbuf;				// queue buffer, NULL if not queuing
+	uint8_t _qsize;				// number of entries in queue buffer
+	volatile uint8_t _qhead;	// next entry to fill
+	volatile uint8_t _qtail;	// next entry to send
+	volatile uint8_t _qbusy;	// set while sending entries (ISR reentrancy guard)
+	volatile int _qstatus;		// error status from sending a queued entry
+	int enqueue(hd44780::iotype type, uint8_t value);
+	void dequeue();
+	void pollReady();
+	int32_t measureExecTime(hd44780::iotype type, uint8_t value, uint32_t exectime);
 
 	// internal API function to send only upper 4 bits of byte on LCD DB4 to DB7 pins
 	int command4bit(uint8_t value)
 	{
-	int status = iowrite(HD44780_IOcmd4bit, value);
-		markStart(_insExecTime);
+	int status = RV_ENOERR;
+		// sent to all controllers, ending with the first one
+		for(uint8_t c = _nctl; c--; )
+		{
+			selectCtl(c);
+		int rv = iowrite(HD44780_IOcmd4bit, value);
+			if(rv)
+				status = rv;
+			markStart(_insExecTime);
+		}
+		_ddramAddr = 0xff; // address counter is not known
+		_ctlAddr[0] = _ctlAddr[1] = _ddramAddr;
 		return(status);
 	}
 
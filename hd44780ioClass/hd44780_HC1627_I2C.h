@@ -74,7 +74,7 @@ public:
 
 hd44780_HC1627_I2C(uint8_t i2c_addr=0) : _Addr(i2c_addr) {} // zero addres means auto locate
 
-private:
+protected:
 // ====================
 // === private data ===
 // ====================
@@ -96,6 +96,21 @@
 #ifndef hd44780_I2Cexp_h
 #define hd44780_I2Cexp_h
 
+// Wire libraries that have getClock() to report the i2c clock rate
+// (define I2Cexp_HAS_GETCLOCK for other cores that have it)
+#if defined(ARDUINO_ARCH_ESP32) && !defined(I2Cexp_HAS_GETCLOCK)
+#define I2Cexp_HAS_GETCLOCK
+#endif
+
+// Wire buffer size, limits the LCD bytes sent in a single i2c transaction
+#if defined(BUFFER_LENGTH)
+#define I2Cexp_BUFLEN BUFFER_LENGTH
+#elif defined(I2C_BUFFER_LENGTH)
+#define I2Cexp_BUFLEN I2C_BUFFER_LENGTH
+#else
+#define I2Cexp_BUFLEN 32
+#endif
+
 // A bug in TinyWireM is that requestFrom() returns incorrect status
 // so its return status can't be used. Instead the code will check the return
 // from Wire.read() which will return -1 if there no data was transfered.
@@ -154,11 +169,11 @@
                                                                         // This breaks the autodetection.
 
 // MCP23008 based boards
-// Currently r/w control is disabled since most boards either can't do it, or have it disabled.
+// r/w control is only enabled on WIDEHK since most boards either can't do it, or have it disabled.
 #define I2Cexp_BOARD_ADAFRUIT292   I2Cexp_MCP23008,1,2,3,4,5,6,7,HIGH // Adafruit #292 i2c/SPI backpack in i2c mode (lcd RW grounded)
                                                                       // GP0 not connected to r/w so no ability to do LCD reads
 
-#define I2Cexp_BOARD_WIDEHK        I2Cexp_MCP23008,4,7,0,1,2,3,6,HIGH // WIDE.HK mini backpack (lcd r/w hooked to GP5)
+#define I2Cexp_BOARD_WIDEHK        I2Cexp_MCP23008,4,5,7,0,1,2,3,6,HIGH // WIDE.HK mini backpack (lcd r/w hooked to GP5)
 
 #define I2Cexp_BOARD_LCDPLUG       I2Cexp_MCP23008,4,6,0,1,2,3,7,HIGH // JeeLabs LCDPLUG (NOTE: NEVER use the SW jumper)
                                                                       // GP5 is hooked to s/w JP1 jumper, LCD RW is hardwired to gnd
@@ -196,10 +211,10 @@ public:
 //	-- Automagic / auto-detect constructors --
 
 // Auto find next instance and auto config pin mapping
-hd44780_I2Cexp(){ _addr = 0; _expType = I2Cexp_UNKNOWN;}
+hd44780_I2Cexp(){ _addr = 0; _expType = I2Cexp_UNKNOWN; _iodir = 0;}
 
 // Auto config specific i2c addr
-hd44780_I2Cexp(uint8_t addr){ _addr = addr; _expType = I2Cexp_UNKNOWN;}
+hd44780_I2Cexp(uint8_t addr){ _addr = addr; _expType = I2Cexp_UNKNOWN; _iodir = 0;}
 
 // Auto locate but with explicit config with r/w control and backlight control
 hd44780_I2Cexp(I2CexpType type, uint8_t rs, uint8_t rw, uint8_t en,
@@ -231,7 +246,7 @@ hd44780_I2Cexp(I2CexpType type, uint8_t rs, uint8_t en,
 // Note: auto locate i2c address is also supported by using address 0 (zero)
 // The init() function is also supported
 hd44780_I2Cexp(uint8_t addr, uint8_t cols, uint8_t rows) : 
-	hd44780(cols, rows), _addr(addr), _expType(I2Cexp_UNKNOWN) {}
+	hd44780(cols, rows), _addr(addr), _expType(I2Cexp_UNKNOWN), _iodir(0) {}
 
 
 // -- Explicit constructors, specify address & pin mapping information --
@@ -328,7 +343,42 @@ int getProp(I2CexpProp propID)
 	}
 }
 
-private:
+// setEnable2() - set the expander pin used for E of the 2nd controller
+// on dual controller displays like 40x4 modules. Must be called before begin()
+int setEnable2(uint8_t en2)
+{
+	if(en2 > 7)
+		return(hd44780::RV_EINVAL);
+	_en2 = (1 << en2);
+	_nctl = 2;
+	return(hd44780::RV_ENOERR);
+}
+
+// setBusClock() - set the i2c clock rate in Hz being used
+// The transfer time of each LCD instruction is then known, and when it
+// is longer than the instruction execution time, hd44780 does not have
+// to track or wait for instructions (only for clear & home).
+// begin() learns the i2c clock rate (see probeBusClock()) when it is not set,
+// call it again if the i2c clock rate is changed after begin().
+// 0 if not known
+int setBusClock(uint32_t hz)
+{
+	if(!hz)
+	{
+		_ioXferTime = 0;
+		return(hd44780::RV_ENOERR);
+	}
+
+	// after the last strobe of an instruction, the next instruction
+	// has at least 3 bytes on the bus before its first E strobe;
+	// the address and the two bytes that raise and lower E.
+	// (the MCP23008 also has the register byte, it is not counted here)
+	// 9 clocks per byte, start and stop bits are not counted.
+	_ioXferTime = (3 * 9 * 1000000UL) / hz;
+	return(hd44780::RV_ENOERR);
+}
+
+protected:
 // ====================
 // === private data ===
 // ====================
@@ -339,6 +389,7 @@ I2CexpType _expType;	// I2C chip type used on the IO expander
 uint8_t _rs;			// I2C chip IO pin mask for Register Select pin
 uint8_t _rw;			// I2C chip IO pin mask for r/w pin
 uint8_t _en;			// I2C chip IO pin mask for enable pin
+uint8_t _en2;			// I2C chip IO pin mask for 2nd controller enable pin
 uint8_t _d4;			// I2C chip IO pin mask for data d4 pin
 uint8_t _d5;			// I2C chip IO pin mask for data d5 pin
 uint8_t _d6;			// I2C chip IO pin mask for data d6 pin
@@ -346,6 +397,9 @@ uint8_t _d7;			// I2C chip IO pin mask for data d7 pin
 uint8_t _bl;			// I2C chip IO pin mask for Backlight
 uint8_t _blLevel;		// backlight active control level HIGH/LOW
 uint8_t _blCurState;	// Current IO pin state mask for Backlight
+uint8_t _nibmap[2][16];	// IO port value for each LCD nibble, [0] cmd, [1] data
+						// includes backlight and RS, see buildNibbleMaps()
+uint8_t _iodir;			// MCP23008 IODIR register value, 0xff if not known
 
 // ==================================================
 // === hd44780 i/o subclass virtual i/o functions ===
@@ -414,6 +468,7 @@ static uint8_t AutoInst;
 
 	// initialize IO expander chip
 
+	_iodir = 0; // all pins outputs
 	Wire.beginTransmission(_addr);
 
 	if(_expType == I2Cexp_MCP23008)
@@ -449,11 +504,70 @@ static uint8_t AutoInst;
 	}
 	Wire.write((uint8_t)0);  // Set the entire output port to LOW
 	if( (status = Wire.endTransmission()) ) // assignment
-		status = hd44780::RV_EIO;
+		return(hd44780::RV_EIO);
+
+	// learn the i2c clock rate if not told so the real transfer
+	// time can be used rather than assuming the fastest i2c clock rate.
+	if(!_ioXferTime)
+		setBusClock(probeBusClock());
 
 	return ( status );
 }
 
+// probeBusClock() - determine the i2c clock rate
+// Uses Wire.getClock() on cores that have it (see I2Cexp_HAS_GETCLOCK)
+// otherwise times a short and a long transfer that rewrite the output port.
+// The Wire library overhead for a transaction is the same for both,
+// so the difference is only the time of the extra bytes on the bus.
+// The shortest of a few samples is used.
+// The rate is classified to a standard i2c clock rate with some margin
+// for timing jitter. Rates above 1MHz are treated as the fastest i2c
+// rate (3.4MHz) so the transfer time is about zero and each LCD byte
+// is waited for.
+// returns clock rate in Hz, 0 if not known
+uint32_t probeBusClock()
+{
+#if defined(I2Cexp_HAS_GETCLOCK)
+	return(Wire.getClock());
+#else
+uint32_t us[2];
+uint32_t delta = 0xffffffff;
+uint32_t hz;
+const uint8_t len[2] = {1, I2Cexp_BUFLEN - 2}; // port bytes, room for MCP23008 register
+
+	for(uint8_t sample = 0; sample < 3; sample++)
+	{
+		for(uint8_t i = 0; i < 2; i++)
+		{
+			us[i] = micros();
+			beginGPIO();
+			for(uint8_t n = 0; n < len[i]; n++)
+				Wire.write((uint8_t)0); // port is already LOW
+			if(Wire.endTransmission())
+				return(0);
+			us[i] = micros() - us[i];
+		}
+		if(us[1] <= us[0]) // too fast to time
+			delta = 0;
+		else if((us[1] - us[0]) < delta)
+			delta = us[1] - us[0];
+	}
+
+	if(!delta)
+		return(3400000);
+
+	hz = ((len[1] - len[0]) * 9 * 1000000UL) / delta;
+
+	if(hz < 150000)
+		return(100000);
+	if(hz < 600000)
+		return(400000);
+	if(hz < 1300000)
+		return(1000000);
+	return(3400000); // fast mode plus or faster
+#endif
+}
+
 // ioread(type) - read a byte from LCD DDRAM
 //
 // returns:
@@ -461,41 +575,59 @@ static uint8_t AutoInst;
 // 	failure: negative value: error or read not supported
 int ioread(hd44780::iotype type) 
 {
+uint8_t data;
+int rval;
+
+	if((rval = ioreadBuf(type, &data, 1)) < 0) // intentional assignment
+		return(rval);
+	return(data);
+}
+
+// ioreadBuf(type, buf, len) - read multiple bytes from the LCD
+// The expander LCD data pins stay in input mode between bytes and
+// the port writes are combined into as few transmissions as possible:
+//	- (MCP23008 only) set the data pins to inputs if they are not already
+//	- set up RS & r/w with E LOW, then raise E for the upper nibble
+//	- read the port
+//	- lower E, then raise E for the lower nibble
+//	- read the port
+//	- lower E, then raise E for the next byte, ...
+//	- lower E, then put the port back to outputs for writes
+// Reading one byte takes 5 i2c transactions.
+// On the MCP23008 the data pins are left as inputs after the read
+// and iowrite() sets them back to outputs, so back to back reads
+// like busy flag polling don't write IODIR each time.
+//
+// returns:
+// 	success:  0
+// 	failure: negative value: error or read not supported
+int ioreadBuf(hd44780::iotype type, uint8_t *buf, size_t len)
+{
+uint32_t chExecTime, insExecTime;
 uint8_t gpioValue =  _blCurState;
-uint8_t data = 0;
-int iodata;
+uint8_t en = _ctl ? _en2 : _en;
+uint8_t pad;
+int hi, lo;
 int rval = hd44780::RV_EIO;
 
 	// If no address or expander type is unknown, then abort read w/error
 	if(!_addr || _expType == I2Cexp_UNKNOWN)
 		return(hd44780::RV_ENXIO);
 
-	// reads for MCP23008 not yet supported
-	if(_expType == I2Cexp_MCP23008)
-	{
-		return(hd44780::RV_ENOTSUP);
-	}
-
 	// check if reads supported
 	if(!_rw)
 		return(hd44780::RV_ENOTSUP);
 
-	/*
-	 * ensure that previous LCD instruction finished.
-	 * There is a 45us offset since there will be at least 2 bytes
-	 * (the i2c address and the i/o expander data)  transmitted over i2c
-	 * before the i/o expander i/o pins could be seen by the LCD.
-	 * (3 bytes on the MCP23008)
-	 * At 400Khz (max rate supported by the i/o expanders) 16 bits plus start
-	 * and stop bits is 45us.
-	 * So there is at least 45us of time overhead in the physical interface.
-	 */
-
-	waitReady(-45);
-   
 	// put all the expander LCD data pins into input mode.
 	// PCF8574 psuedo inputs use pullups so setting them to 1
 	// makes them suitible for inputs.
+	// The MCP23008 uses the IODIR register.
+
+	if(_expType == I2Cexp_MCP23008)
+	{
+		if(setIODIR(_d4|_d5|_d6|_d7))
+			return(hd44780::RV_EIO);
+	}
 
 	gpioValue |= _d4|_d5|_d6|_d7;
 
@@ -507,66 +639,131 @@ int rval = hd44780::RV_EIO;
 
 	gpioValue |= _rw; // r/w high for reading
 
-	// write all the bits to the expander port
-	
-	Wire.beginTransmission(_addr);
+	// between bytes, the read must finish executing before E is raised
+	// again. Like iowriteBuf(), two expander bytes is long enough unless
+	// the bus clock is known to be faster than 400kHz or the instruction
+	// execution time is longer than the gap.
+	getExecTimes(chExecTime, insExecTime);
+	pad = (byteGap() >= insExecTime);
+
+	/*
+	 * ensure that previous LCD instruction finished.
+	 * There are 3 bytes (the i2c address and two i/o expander data bytes)
+	 * transmitted over i2c before E is raised for the read.
+	 * (4 bytes on the MCP23008)
+	 * When the i2c clock rate is known, the transfer time is used
+	 * as the offset (see setBusClock()), otherwise there is a 45us offset.
+	 * At 400Khz (max rate supported by the i/o expanders) 16 bits plus start
+	 * and stop bits is 45us.
+	 * So there is at least 45us of time overhead in the physical interface.
+	 */
+
+	waitReady(_ioXferTime ? -(int32_t) _ioXferTime : -45);
+
+	beginGPIO();
 	Wire.write(gpioValue);		// d4-d7 are inputs, RS, r/w high, E LOW
+	Wire.write(gpioValue | en);	// Raise E to read upper nibble
 	if(Wire.endTransmission())
 		goto returnStatus;
 
+	while(len)
+	{
+		// read the expander port to get the upper nibble of the byte
+		if((hi = readNibble()) < 0) // intentional assignment
+			goto returnStatus;
 
-	// raise E to read the data.
-	Wire.beginTransmission(_addr);
-	Wire.write(gpioValue | _en); // Raises E 
-	if(Wire.endTransmission())
-		goto returnStatus;
+		beginGPIO();
+		Wire.write(gpioValue);		// lower E after reading nibble
+		Wire.write(gpioValue | en);	// Raise E to read lower nibble
+		if(Wire.endTransmission())
+			goto returnStatus;
 
-	// read the expander port to get the upper nibble of the byte
-	Wire.requestFrom((int)_addr, 1);
-	iodata = Wire.read();
-	if(iodata < 0) // did we not receive a byte?
-		goto returnStatus;
+		// read the expander port to get the lower nibble of the byte
+		if((lo = readNibble()) < 0) // intentional assignment
+			goto returnStatus;
 
-	Wire.beginTransmission(_addr);
-	Wire.write(gpioValue); // lower E after reading nibble
-	if(Wire.endTransmission())
-		goto returnStatus;
+		*buf++ = (hi << 4) | lo;
+		if(!--len)
+			break;
 
-	// map i/o expander port bits into upper nibble of byte
-	if(iodata & _d4)
-		data |= (1 << 4);
+		beginGPIO();
+		Wire.write(gpioValue);		// lower E to end the read
+		if(pad)
+		{
+			Wire.write(gpioValue);	// pad for the read execution time
+		}
+		else
+		{
+			if(Wire.endTransmission())
+				goto returnStatus;
+			delayMicroseconds(insExecTime - byteGap());
+			beginGPIO();
+		}
+		Wire.write(gpioValue | en);	// Raise E to read next byte
+		if(Wire.endTransmission())
+			goto returnStatus;
+	}
 
-	if(iodata & _d5)
-		data |= (1 << 5);
+	rval = hd44780::RV_ENOERR;
 
-	if(iodata & _d6)
-		data |= (1 << 6);
+returnStatus:
 
-	if(iodata & _d7)
-		data |= (1 << 7);
-	
-	Wire.beginTransmission(_addr);
-	Wire.write(gpioValue | _en); // Raise E to read next nibble
+	// try to put gpio port back to all outputs state with WR signal low for writes
+	// (MCP23008 data pins stay inputs until the next write)
+	beginGPIO();
+	Wire.write(gpioValue);			// lower E
+	Wire.write(_blCurState);		// with E LOW
 	if(Wire.endTransmission())
-		goto returnStatus;
+		rval = hd44780::RV_EIO;
 
-	// read the expander port to get the lower nibble of the byte
-	// We can't look at the return value from requestFrom() on the TineyWireM
-	// library as it doesn't work like it is supposed to.
-	// So we look at the return status from read() instead.
-	Wire.requestFrom((int)_addr, 1);
+	return(rval);
+}
 
-	iodata = Wire.read();
+// beginGPIO() - start a transmission to the expander port
+inline void beginGPIO()
+{
+	Wire.beginTransmission(_addr);
+	if(_expType == I2Cexp_MCP23008)
+		Wire.write(9); // point to GPIO
+}
 
-	if(iodata < 0) // did we not receive a byte?
-		goto returnStatus;
+// setIODIR() - set the MCP23008 pin directions
+// Nothing is sent if the pins are already set.
+// returns zero on success, non zero on failure
+int setIODIR(uint8_t iodir)
+{
+	if(iodir == _iodir)
+		return(hd44780::RV_ENOERR);
 
 	Wire.beginTransmission(_addr);
-	Wire.write(gpioValue); // lower E after reading nibble
+	Wire.write((uint8_t)0); // point to IODIR
+	Wire.write(iodir);
 	if(Wire.endTransmission())
-		goto returnStatus;
+	{
+		_iodir = 0xff; // not known
+		return(hd44780::RV_EIO);
+	}
+	_iodir = iodir;
+	return(hd44780::RV_ENOERR);
+}
 
-	// map i/o expander port bits into lower nibble of byte
+// readNibble() - read the expander port and map the LCD data pins
+// into a nibble.
+// We can't look at the return value from requestFrom() on the TineyWireM
+// library as it doesn't work like it is supposed to.
+// So we look at the return status from read() instead.
+// returns nibble, negative value on failure
+int readNibble()
+{
+int iodata;
+uint8_t data = 0;
+
+	Wire.requestFrom((int)_addr, 1);
+	iodata = Wire.read();
+	if(iodata < 0) // did we not receive a byte?
+		return(hd44780::RV_EIO);
+
+	// map i/o expander port bits into nibble
 	if(iodata & _d4)
 		data |= (1 << 0);
 
@@ -579,17 +776,7 @@ int rval = hd44780::RV_EIO;
 	if(iodata & _d7)
 		data |= (1 << 3);
 
-	rval = data;
-
-returnStatus:
-
-	// try to put gpio port back to all outputs state with WR signal low for writes
-	Wire.beginTransmission(_addr);
-	Wire.write(_blCurState);		// with E LOW
-	if(Wire.endTransmission())
-		rval = hd44780::RV_EIO;
-
-	return(rval);
+	return(data);
 }
 
 // iowrite(type, value) - send either command or data byte to lcd
@@ -600,6 +787,10 @@ int iowrite(hd44780::iotype type, uint8_t value)
 	if(!_addr || _expType == I2Cexp_UNKNOWN)
 		return(hd44780::RV_ENXIO);
 
+	// MCP23008 data pins are left as inputs after reads
+	if(_iodir && setIODIR(0))
+		return(hd44780::RV_EIO);
+
 	/*
 	 * ensure that previous LCD instruction finished.
 	 * There is a 45us offset since there will be at least 2 bytes
@@ -609,9 +800,10 @@ int iowrite(hd44780::iotype type, uint8_t value)
 	 * At 400Khz (max rate supported by the i/o expanders) 16 bits plus start
 	 * and stop bits is 45us.
 	 * So there is at least 45us of time overhead in the physical interface.
+	 * When the bus clock is known, the actual time is used.
 	 */
 
-	waitReady(-45);
+	waitReady(_ioXferTime ? -(int32_t) _ioXferTime : -45);
    
 	// grab i2c bus
 	Wire.beginTransmission(_addr);
@@ -640,6 +832,82 @@ int iowrite(hd44780::iotype type, uint8_t value)
 	return(hd44780::RV_ENOERR);
 }
 
+// iowriteBuf() - send multiple command or data bytes to the lcd
+// Bytes are sent in as few i2c transactions as the Wire buffer allows.
+// Within a transaction, there are two i/o expander bytes between the
+// last E strobe of one LCD byte and the first E strobe of the next
+// which takes longer than the instruction execution time
+// at 400kHz (45us) and slower. If the bus clock is known to be faster
+// than that, or the instruction execution time is longer than the gap
+// (45us when the bus clock is not known), each byte is sent in its own
+// transaction.
+// returns zero on success, non zero on failure
+int iowriteBuf(hd44780::iotype type, const uint8_t *buf, size_t len)
+{
+uint32_t chExecTime, insExecTime;
+uint8_t n;
+
+	// If no address or expander type is unknown, then drop data
+	if(!_addr || _expType == I2Cexp_UNKNOWN)
+		return(hd44780::RV_ENXIO);
+
+	// MCP23008 data pins are left as inputs after reads
+	if(_iodir && setIODIR(0))
+		return(hd44780::RV_EIO);
+
+	getExecTimes(chExecTime, insExecTime);
+	if((type == hd44780::HD44780_IOcmd4bit) || (byteGap() < insExecTime))
+		return(hd44780::iowriteBuf(type, buf, len));
+
+	// ensure that previous LCD instruction finished. (see iowrite())
+	waitReady(_ioXferTime ? -(int32_t) _ioXferTime : -45);
+
+	while(len)
+	{
+		Wire.beginTransmission(_addr);
+		n = I2Cexp_BUFLEN / 4;
+		if(_expType == I2Cexp_MCP23008)
+		{
+			Wire.write(9); // point to GPIO
+			n = (I2Cexp_BUFLEN - 1) / 4;
+		}
+		for(; n && len; n--, len--)
+		{
+			write4bits((*buf >> 4), type);	// upper nibble
+			write4bits((*buf & 0x0F), type);	// lower nibble
+			buf++;
+		}
+		if(Wire.endTransmission()) // send buffered bytes to the expander
+			return(hd44780::RV_EIO);
+	}
+	return(hd44780::RV_ENOERR);
+}
+
+// byteGap() - time in us of two expander bytes on the bus
+// assumes 400kHz (45us) when the bus clock is not known
+inline uint32_t byteGap()
+{
+	return(_ioXferTime ? (_ioXferTime * 2UL) / 3 : 45);
+}
+
+// ioaddrCost() - number of data bytes that take as long as setting the address
+// When data bytes are sent in bursts, each one is 4 expander bytes.
+// Setting the address ends the burst and is sent in its own transaction
+// (i2c address, MCP23008 register, 4 expander bytes) and then the next
+// burst needs another i2c address and register byte.
+// That is 6 bytes on the PCF8574 and 8 on the MCP23008 plus start/stop
+// bits, which is 2 data bytes in either case.
+// When each byte is sent in its own transaction, it is the same as one byte.
+uint8_t ioaddrCost()
+{
+uint32_t chExecTime, insExecTime;
+
+	getExecTimes(chExecTime, insExecTime);
+	if(byteGap() < insExecTime)
+		return(1);
+	return(2);
+}
+
 // iosetBacklight()  - set backlight brightness
 // Since dimming is not supported, any non zero value
 // will turn on the backlight.
@@ -659,6 +927,7 @@ int iosetBacklight(uint8_t dimvalue)
 	{
 		_blCurState = 0;
 	}
+	buildNibbleMaps();
 	Wire.beginTransmission(_addr);
 	if(_expType == I2Cexp_MCP23008)
 	{
@@ -683,6 +952,7 @@ void config(uint8_t i2c_addr, I2CexpType i2c_type, uint8_t rs, uint8_t rw, uint8
 	// Save away config data into object
 	_expType = i2c_type;
 	_addr = i2c_addr;
+	_iodir = 0; // all pins outputs
    
 	_rs = ( 1 << rs );
 
@@ -714,6 +984,34 @@ void config(uint8_t i2c_addr, I2CexpType i2c_type, uint8_t rs, uint8_t rw, uint8
 		_blCurState = _bl;
 	else
 		_blCurState = 0;
+
+	buildNibbleMaps();
+}
+
+// buildNibbleMaps() - create i/o expander port values for each LCD nibble
+// so write4bits() does not have to map the bits for each nibble.
+// Must be called when the pin mappings or the backlight state change.
+void buildNibbleMaps()
+{
+	for(uint8_t value = 0; value < 16; value++)
+	{
+	uint8_t gpioValue = _blCurState;
+
+		if(value & (1 << 0))
+			gpioValue |= _d4;
+
+		if(value & (1 << 1))
+			gpioValue |= _d5;
+
+		if(value & (1 << 2))
+			gpioValue |= _d6;
+
+		if(value & (1 << 3))
+			gpioValue |= _d7;
+
+		_nibmap[0][value] = gpioValue;			// RS low for cmd reg
+		_nibmap[1][value] = gpioValue | _rs;	// RS high for data reg
+	}
 }
 
 //  LocateDevice() - Locate I2C expander device instance
@@ -1104,6 +1402,7 @@ int autocfgMCP23008()
 {
 uint8_t data;
 uint8_t rs, en, d4, d5, d6, d7, bl;
+uint8_t rw = 0xff; // no r/w control
 uint8_t blLevel;
 
 	/*
@@ -1150,7 +1449,7 @@ uint8_t blLevel;
 	{
 		// WIDEHK
 		rs = 4;
-		// rw = 5; // not used
+		rw = 5;
 		en = 7;
 		d4 = 0;
 		d5 = 1;
@@ -1176,8 +1475,7 @@ uint8_t blLevel;
 		// could not identify board
 		return(hd44780::RV_ENOTSUP);
 	}
-	// currently writes are disabled for all MCP23008 devices
-	config(_addr, _expType, rs, 0xff, en, d4, d5, d6, d7, bl, blLevel);
+	config(_addr, _expType, rs, rw, en, d4, d5, d6, d7, bl, blLevel);
 	return(0);
 }
 
@@ -1185,31 +1483,13 @@ uint8_t blLevel;
 // write4bits - send a nibble to the LCD through i/o expander port
 void write4bits(uint8_t value, hd44780::iotype type ) 
 {
-uint8_t gpioValue =  _blCurState;
-   
 	// convert the value to an i/o expander port value
-	// based on pin mappings
-	if(value & (1 << 0))
-		gpioValue |= _d4;
-
-	if(value & (1 << 1))
-		gpioValue |= _d5;
-
-	if(value & (1 << 2))
-		gpioValue |= _d6;
+	// based on pin mappings, RS, and backlight state
+uint8_t gpioValue = _nibmap[type == hd44780::HD44780_IOdata][value & 0x0f];
 
-	if(value & (1 << 3))
-		gpioValue |= _d7;
-
-
-	if(type == hd44780::HD44780_IOdata) 
-	{
-		gpioValue |= _rs; // set RS high to send to data reg
-	}
-   
 	// Cheat here by raising E at the same time as setting control lines
 	// This violates the spec but seems to work realiably.
-	Wire.write(gpioValue |_en);	// with E HIGH
+	Wire.write(gpioValue | (_ctl ? _en2 : _en));	// with E HIGH
 	Wire.write(gpioValue);		// with E LOW
 }
 	
@@ -109,7 +109,7 @@ public:
 
 hd44780_I2Clcd(uint8_t i2c_addr=0) : _Addr(i2c_addr) {} // zero addres means auto locate
 
-private:
+protected:
 // ====================
 // === private data ===
 // ====================
@@ -77,7 +77,7 @@ hd44780_NTCU165ECPB(int cs) : hd44780(16,1), _cs(cs), _clk(SCK), _data(MOSI) { }
 hd44780_NTCU165ECPB(int cs, int clock, int data) : hd44780(16,1), _cs(cs), _clk(clock), _data(data) { }
 
 
-private:
+protected:
 // ====================
 // === private data ===
 // ====================
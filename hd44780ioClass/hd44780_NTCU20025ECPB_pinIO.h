@@ -111,7 +111,7 @@ hd44780_NTCU20025ECPB_pinIO(uint8_t rs,  uint8_t rw, uint8_t en,
 	hd44780(20,2), _rs(rs), _rw(rw), _en(en),
 	_d4(d4), _d5(d5), _d6(d6), _d7(d7) { }
 
-private:
+protected:
 // ====================
 // === private data ===
 // ====================
@@ -77,7 +77,7 @@ public:
 	// supply pins for chip select, clock, and data
 	hd44780_NTCUUserial(uint8_t cs, uint8_t clk, uint8_t data) : _cs(cs), _clk(clk), _data(data) { }
 	
-private:
+protected:
 	// ====================
 	// === private data ===
 	// ====================
@@ -127,8 +127,17 @@ hd44780_pinIO(uint8_t rs,  uint8_t rw, uint8_t en,
 	_blLevel = blLevel;
 }
 
+// setEnable2() - set the E pin for the 2nd controller on dual controller
+// displays like 40x4 modules. Must be called before begin()
+int setEnable2(uint8_t en2)
+{
+	_en2 = en2;
+	_nctl = 2;
+	return(RV_ENOERR);
+}
+
 
-private:
+protected:
 // ====================
 // === private data ===
 // ====================
@@ -137,6 +146,7 @@ private:
 uint8_t _rs;		// hd44780 rs arduino pin
 uint8_t _rw;		// hd44780 rw arduino pin
 uint8_t _en;		// hd44780 en arduino pin
+uint8_t _en2;		// hd44780 en arduino pin for 2nd controller
 uint8_t _d4;		// hd44780 d4 arduino pin
 uint8_t _d5;		// hd44780 d4 arduino pin
 uint8_t _d6;		// hd44780 d4 arduino pin
@@ -177,6 +187,12 @@ int ioinit()
 	pinMode(_en, OUTPUT);
 	digitalWrite(_en, LOW);
 
+	if(_nctl > 1)
+	{
+		pinMode(_en2, OUTPUT);
+		digitalWrite(_en2, LOW);
+	}
+
 	pinMode(_d4, OUTPUT);
 	pinMode(_d5, OUTPUT);
 	pinMode(_d6, OUTPUT);
@@ -233,7 +249,7 @@ uint8_t data = 0;
 	digitalWrite(_rw, HIGH);
 
 	// raise E to allow reading the data.
-	digitalWrite(_en, HIGH);
+	digitalWrite(_ctl ? _en2 : _en, HIGH);
 
 	// allow for hd44780 tDDR (Data delay time) before reading data
 	// this could be much shorter but this is portable for all CPUs.
@@ -254,14 +270,14 @@ uint8_t data = 0;
 		data |= (1 << 7);
 
 	// lower E after reading nibble
-	digitalWrite(_en, LOW);
+	digitalWrite(_ctl ? _en2 : _en, LOW);
 
 	// allow for hd44780 1/2 of tcycE (Enable cycle time)
 	// this could be much shorter but this is portable for all CPUs.
 	delayMicroseconds(1);
 	
 	// raise E to allow reading the lower nibbly of the byte
-	digitalWrite(_en, HIGH);
+	digitalWrite(_ctl ? _en2 : _en, HIGH);
 
 	// allow for hd44780 tDDR (Data delay time) before reading data
 	// this could be shorter but this is portable for all CPUs.
@@ -283,7 +299,7 @@ uint8_t data = 0;
 
    
 	// lower E after reading nibble
-	digitalWrite(_en, LOW);
+	digitalWrite(_ctl ? _en2 : _en, LOW);
 
 	//
 	// put all pins back into state for writing to LCD
@@ -442,7 +458,7 @@ void write4bits(uint8_t value)
 // pulseEnable() - toggle en to send data to hd44780 module
 void pulseEnable(void)
 {
-	digitalWrite(_en, HIGH);
+	digitalWrite(_ctl ? _en2 : _en, HIGH);
 #if defined (ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
 	// the extra delay here is not for the LCD, it is to allow signal lines time
 	// to settle when using 3v esp modules with 5v LCDs.
@@ -455,7 +471,7 @@ void pulseEnable(void)
 #else
 	delayMicroseconds(1);    // enable pulse must be >450ns
 #endif
-	digitalWrite(_en, LOW);
+	digitalWrite(_ctl ? _en2 : _en, LOW);
 }
 
 //
@@ -0,0 +1,174 @@
+//  vi:ts=4
+// ---------------------------------------------------------------------------
+//  hd44780_canvas.h - virtual text canvas for hd44780 library
+//
+// ---------------------------------------------------------------------------
+//
+//  This file is part of the hd44780 library
+//
+//  hd44780_canvas is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation version 3 of the License.
+//
+//  hd44780_canvas is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with hd44780_canvas.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// hd44780_canvas is a text canvas in RAM that can be larger than the LCD.
+// The LCD shows a viewport of the canvas that can be moved around.
+// The canvas is a Print class so all the print() functions can be used
+// to draw on it.
+//
+// update() copies the viewport to the LCD shadow buffer and uses
+// flushShadow() so only the characters that changed on the LCD are sent.
+// Moving the viewport only sends the LCD characters whose contents changed,
+// so rows that show the same characters after a move are not sent again.
+// The LCD row offsets are used by flushShadow() so all LCD geometries
+// work the same.
+//
+// The LCD must be using a shadow buffer.
+//
+// Usage:
+//	uint8_t lcdshadow[HD44780_SHADOWSIZE(LCD_COLS, LCD_ROWS)];
+//	uint8_t canvasbuf[40*10];
+//	hd44780_canvas canvas(lcd, LCD_COLS, LCD_ROWS, canvasbuf, 40, 10);
+//
+//	lcd.begin(LCD_COLS, LCD_ROWS);
+//	lcd.shadowBuffer(lcdshadow, sizeof(lcdshadow));
+//	canvas.setCursor(0, 5);
+//	canvas.print("hello");
+//	canvas.setViewport(0, 4);
+//	canvas.update();
+//
+// Characters written past the right edge of the canvas are dropped.
+// '\r' moves to column 0, '\n' moves to column 0 of the next row.
+//
+// ---------------------------------------------------------------------------
+#ifndef hd44780_canvas_h
+#define hd44780_canvas_h
+
+class hd44780_canvas : public Print
+{
+public:
+// ====================
+// === constructors ===
+// ====================
+
+// buf must be width * height bytes
+hd44780_canvas(hd44780 &lcd, uint8_t cols, uint8_t rows, uint8_t *buf, uint16_t width, uint16_t height) :
+	_lcd(lcd), _cols(cols), _rows(rows), _buf(buf), _width(width), _height(height)
+{
+	clear();
+}
+
+// clear() - fill canvas with spaces and set cursor and viewport to 0,0
+void clear(void)
+{
+	memset(_buf, ' ', (size_t) _width * _height);
+	_col = 0;
+	_row = 0;
+	_vcol = 0;
+	_vrow = 0;
+}
+
+// setCursor() - set canvas position for the next character
+int setCursor(uint16_t col, uint16_t row)
+{
+	if((col >= _width) || (row >= _height))
+		return(hd44780::RV_EINVAL);
+	_col = col;
+	_row = row;
+	return(hd44780::RV_ENOERR);
+}
+
+// write() - draw a character on the canvas
+size_t write(uint8_t value)
+{
+	if(value == '\r')
+	{
+		_col = 0;
+		return(1);
+	}
+	if(value == '\n')
+	{
+		_col = 0;
+		if(_row < _height)
+			_row++;
+		return(1);
+	}
+	if((_col < _width) && (_row < _height))
+		_buf[(size_t) _row * _width + _col] = value;
+	_col++;
+	return(1);
+}
+using Print::write; // for other Print Class write() functions
+
+// setViewport() - set canvas position shown in the top left of the LCD
+// The viewport is limited to the canvas
+int setViewport(uint16_t col, uint16_t row)
+{
+	if((col >= _width) || (row >= _height))
+		return(hd44780::RV_EINVAL);
+	_vcol = col;
+	_vrow = row;
+	return(hd44780::RV_ENOERR);
+}
+uint16_t viewportCol(void) { return(_vcol); }
+uint16_t viewportRow(void) { return(_vrow); }
+
+// update() - update the LCD with the viewport of the canvas
+// only the LCD characters that changed are sent to the LCD
+// returns 0 on success, non zero on failure
+// RV_ENOTSUP if the LCD is not using a shadow buffer
+int update(void)
+{
+	// without a shadow buffer the writes below would go straight to
+	// the LCD, so check before touching the display.
+	if(!_lcd.shadowEnabled())
+		return(hd44780::RV_ENOTSUP);
+
+	for(uint8_t r = 0; r < _rows; r++)
+	{
+	uint16_t row = _vrow + r;
+
+		_lcd.setCursor(0, r);
+		for(uint8_t c = 0; c < _cols; c++)
+		{
+		uint16_t col = _vcol + c;
+
+			// areas outside the canvas are blank
+			if((row < _height) && (col < _width))
+				_lcd.write(_buf[(size_t) row * _width + col]);
+			else
+				_lcd.write(' ');
+		}
+	}
+
+	// put the LCD cursor at the canvas cursor when it is in the viewport
+	if((_col >= _vcol) && (_col - _vcol < _cols) && (_row >= _vrow) && (_row - _vrow < _rows))
+		_lcd.setCursor(_col - _vcol, _row - _vrow);
+
+	return(_lcd.flushShadow());
+}
+void flush(void) { update(); } // Print class flush()
+
+private:
+hd44780 &_lcd;
+uint8_t _cols;		// LCD columns
+uint8_t _rows;		// LCD rows
+uint8_t *_buf;		// canvas characters, row by row
+uint16_t _width;	// canvas columns
+uint16_t _height;	// canvas rows
+uint16_t _col;		// canvas cursor
+uint16_t _row;
+uint16_t _vcol;		// canvas position shown at top left of LCD
+uint16_t _vrow;
+
+}; // end of class definition
+#endif
@@ -0,0 +1,172 @@
+//  vi:ts=4
+// ---------------------------------------------------------------------------
+//  hd44780_fixed.h - fixed geometry front end for hd44780 library
+//
+// ---------------------------------------------------------------------------
+//
+//  This file is part of the hd44780 library
+//
+//  hd44780_fixed is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation version 3 of the License.
+//
+//  hd44780_fixed is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with hd44780_fixed.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// hd44780_fixed is a template that wraps an i/o class for an LCD with
+// a geometry that is known at compile time.
+// The columns, rows, and row offsets are constants so the cursor
+// positioning and line wrap math in setCursor() and write() is done
+// by the compiler rather than at runtime.
+// The shadow buffer (see shadowBuffer()) can be part of the object so its
+// RAM usage is known at link time.
+//
+// Template parameters:
+//	IO     - i/o class
+//	COLS   - columns
+//	ROWS   - rows
+//	SHADOW - nonzero to have begin() enable a shadow buffer in the object
+//
+// The constructor parameters are the same as the i/o class.
+//
+// Usage:
+//	hd44780_fixed<hd44780_I2Cexp, 20, 4> lcd;
+//	hd44780_fixed<hd44780_pinIO, 16, 2, 1> lcd2(rs, en, db4, db5, db6, db7);
+//
+//	lcd.begin();
+//	lcd2.begin(); // shadow buffer is enabled, use flushShadow()
+//
+// NOTE:
+//	The row offsets are the standard ones used by begin() and
+//	must not be changed using setRowOffsets().
+//	Requires C++11 (Arduino IDE 1.6.6 or later)
+//
+// ---------------------------------------------------------------------------
+#ifndef hd44780_fixed_h
+#define hd44780_fixed_h
+
+#if __cplusplus < 201103L
+#error hd44780_fixed requires C++11
+#endif
+
+template <class IO, uint8_t COLS, uint8_t ROWS, uint8_t SHADOW = 0>
+class hd44780_fixed : public IO
+{
+	static_assert((COLS > 0) && (COLS <= 80), "hd44780_fixed: COLS must be 1 to 80");
+	static_assert((ROWS > 0) && (ROWS <= 4), "hd44780_fixed: ROWS must be 1 to 4");
+
+public:
+// ====================
+// === constructors ===
+// ====================
+
+template <typename... Args>
+hd44780_fixed(Args... args) : IO(args...) { }
+
+// geometry
+static constexpr uint8_t cols(void) { return(COLS); }
+static constexpr uint8_t rows(void) { return(ROWS); }
+
+// rowOffset() - DDRAM address of the start of a row
+// these are the same as the defaults set by begin()
+static constexpr uint8_t rowOffset(uint8_t row)
+{
+	return(((row & 1) ? 0x40 : 0x00) + ((row & 2) ? COLS : 0));
+}
+
+// begin() - initialize the LCD
+// also enables the shadow buffer when SHADOW is nonzero
+// returns 0 on success, non zero on failure
+int begin(void)
+{
+int rval = IO::begin(COLS, ROWS);
+
+	if(!rval && SHADOW)
+		rval = IO::shadowBuffer(_shadowbuf, sizeof(_shadowbuf));
+	return(rval);
+}
+
+// setCursor() - same as hd44780 setCursor() with constant geometry
+int setCursor(uint8_t col, uint8_t row)
+{
+	if(!this->directMode())
+		return(IO::setCursor(col, row));
+
+	if(row >= ROWS)
+		row = ROWS - 1;
+
+	if(this->_wraplines)
+	{
+		row = (row + col / COLS) % ROWS;
+		col %= COLS;
+		this->_curcol = col;
+		this->_currow = row;
+	}
+	return(this->setAddr((col + rowOffset(row)) & 0x7f));
+}
+
+// write() - same as hd44780 write() with constant geometry
+size_t write(uint8_t value)
+{
+size_t rval;
+
+	if(!this->directMode())
+		return(IO::write(value));
+
+	rval = this->_write(value);
+
+	if(this->_wraplines && (++this->_curcol >= COLS))
+	{
+		this->_curcol = 0;
+		if(++this->_currow >= ROWS)
+			this->_currow = 0;
+		this->setAddr(rowOffset(this->_currow));
+	}
+	return(rval);
+}
+
+// write() - same as hd44780 write() of a buffer with constant geometry
+// returns number of bytes successfully written to device
+size_t write(const uint8_t *buffer, size_t size)
+{
+size_t n = 0;
+size_t len;
+
+	if(!this->directMode())
+		return(IO::write(buffer, size));
+
+	while(n < size)
+	{
+		// with line wrapping, bytes are sent a line at a time
+		len = size - n;
+		if(this->_wraplines && (len > (size_t) (COLS - this->_curcol)))
+			len = COLS - this->_curcol;
+
+		if(this->_writeBuf(buffer + n, len))
+			break;
+		n += len;
+
+		if(this->_wraplines && ((this->_curcol += len) >= COLS))
+		{
+			this->_curcol = 0;
+			if(++this->_currow >= ROWS)
+				this->_currow = 0;
+			this->setAddr(rowOffset(this->_currow));
+		}
+	}
+	return(n);
+}
+using IO::write; // for other write() functions
+
+private:
+uint8_t _shadowbuf[SHADOW ? HD44780_SHADOWSIZE(COLS, ROWS) : 1];
+
+}; // end of class definition
+#endif
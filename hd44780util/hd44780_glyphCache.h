@@ -0,0 +1,156 @@
+//  vi:ts=4
+// ---------------------------------------------------------------------------
+//  hd44780_glyphCache.h - custom character cache for hd44780 library
+//
+// ---------------------------------------------------------------------------
+//
+//  This file is part of the hd44780 library
+//
+//  hd44780_glyphCache is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation version 3 of the License.
+//
+//  hd44780_glyphCache is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with hd44780_glyphCache.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// The hd44780 only has 8 custom characters (CGRAM slots).
+// hd44780_glyphCache allows using a larger table of glyphs by loading
+// glyphs into the CGRAM slots as they are used.
+// When all the slots are in use, the least recently used slot is reused.
+// Glyphs that are already loaded are not sent to the LCD again.
+//
+// The glyph table is an array of 8 byte bitmaps, one per glyph,
+// the glyph id is the index into the table.
+// A const glyph table is assumed to be in PROGMEM just like createChar()
+//
+// Usage:
+//	const PROGMEM uint8_t icons[][8] = { {...}, {...}, ... };
+//	hd44780_glyphCache glyphs(lcd, icons, sizeof(icons)/sizeof(icons[0]));
+//
+//	lcd.write(glyphs.glyph(3)); // load glyph id 3 if needed and display it
+//
+// NOTE:
+//	Reusing a slot changes any characters on the display that are using it.
+//	So no more than 8 different glyphs should be on the display at the same time.
+//	Call reset() after begin() since begin() does not clear the CGRAM
+//	but the contents are no longer known.
+//
+// ---------------------------------------------------------------------------
+#ifndef hd44780_glyphCache_h
+#define hd44780_glyphCache_h
+
+class hd44780_glyphCache
+{
+public:
+// ====================
+// === constructors ===
+// ====================
+
+// glyph table in flash (PROGMEM on processors that need it)
+hd44780_glyphCache(hd44780 &lcd, const uint8_t glyphs[][8], uint8_t nglyphs) :
+	_lcd(lcd), _pglyphs(glyphs), _rglyphs(0), _nglyphs(nglyphs) { reset(); }
+
+// glyph table in RAM
+hd44780_glyphCache(hd44780 &lcd, uint8_t glyphs[][8], uint8_t nglyphs) :
+	_lcd(lcd), _pglyphs(0), _rglyphs(glyphs), _nglyphs(nglyphs) { reset(); }
+
+// glyph() - get the character code for a glyph
+// loads the glyph into a CGRAM slot if it is not already loaded
+// returns:
+//	success: character code (0-7) to write to the display
+//	failure: negative value
+int glyph(uint8_t id)
+{
+uint8_t i;
+uint8_t slot;
+int rval;
+
+	if(id >= _nglyphs)
+		return(hd44780::RV_EINVAL);
+
+	// look for glyph in the slots, most recently used first
+	for(i = 0; i < 8; i++)
+	{
+		if(_slotGlyph[_lru[i]] == id)
+			break;
+	}
+
+	if(i < 8)
+	{
+		_hits++;
+		slot = _lru[i];
+	}
+	else
+	{
+		// reuse least recently used slot
+		_misses++;
+		i = 7;
+		slot = _lru[i];
+		if(_pglyphs)
+			rval = _lcd.createChar(slot, _pglyphs[id]);
+		else
+			rval = _lcd.createChar(slot, _rglyphs[id]);
+		if(rval)
+		{
+			_slotGlyph[slot] = NOGLYPH; // slot contents are not known
+			return(rval);
+		}
+		_slotGlyph[slot] = id;
+	}
+
+	// move slot to front of LRU list
+	for(; i; i--)
+		_lru[i] = _lru[i-1];
+	_lru[0] = slot;
+
+	return(slot);
+}
+
+// write() - display a glyph
+// returns number of characters written
+size_t write(uint8_t id)
+{
+int charcode = glyph(id);
+
+	if(charcode < 0)
+		return(0);
+	return(_lcd.write((uint8_t) charcode));
+}
+
+// reset() - mark all slots as empty
+void reset(void)
+{
+	for(uint8_t i = 0; i < 8; i++)
+	{
+		_slotGlyph[i] = NOGLYPH;
+		_lru[i] = 7 - i; // so slot 0 is used first
+	}
+	_hits = 0;
+	_misses = 0;
+}
+
+// cache statistics
+uint32_t hits(void) { return(_hits); }		// glyphs already loaded
+uint32_t misses(void) { return(_misses); }	// glyphs that had to be loaded
+
+private:
+static const uint8_t NOGLYPH = 0xff; // slot does not have a known glyph
+
+hd44780 &_lcd;
+const uint8_t (*_pglyphs)[8];	// glyph table in flash
+uint8_t (*_rglyphs)[8];			// glyph table in RAM
+uint8_t _nglyphs;				// number of glyphs in table
+uint8_t _slotGlyph[8];			// glyph id loaded in each slot
+uint8_t _lru[8];				// slots, most recently used first
+uint32_t _hits;
+uint32_t _misses;
+
+}; // end of class definition
+#endif
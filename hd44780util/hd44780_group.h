@@ -0,0 +1,147 @@
+//  vi:ts=4
+// ---------------------------------------------------------------------------
+//  hd44780_group.h - multiple display scheduler for hd44780 library
+//
+// ---------------------------------------------------------------------------
+//
+//  This file is part of the hd44780 library
+//
+//  hd44780_group is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation version 3 of the License.
+//
+//  hd44780_group is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with hd44780_group.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// hd44780_group sends queued commands and data for a group of displays,
+// like several hd44780_I2Cexp displays on the same i2c bus.
+// Each display must be using a queue buffer (see queueBuffer()) so the
+// API calls return without waiting for the LCD.
+//
+// poll() sends the next queued entry to each display that is ready,
+// so while one display is executing a long instruction like clear,
+// the other displays are being sent their entries rather than the
+// bus sitting idle.
+// flush() does the same until all the queues are empty.
+//
+// Usage:
+//	hd44780_I2Cexp lcd1(0x20), lcd2(0x21), lcd3(0x22);
+//	hd44780 *lcds[] = { &lcd1, &lcd2, &lcd3 };
+//	hd44780_group group(lcds, sizeof(lcds)/sizeof(lcds[0]));
+//	uint8_t q1[HD44780_QUEUESIZE(32)], q2[HD44780_QUEUESIZE(32)], ...
+//
+//	lcd1.begin(16, 2); lcd1.queueBuffer(q1, sizeof(q1));
+//	...
+//	lcd1.clear(); lcd2.clear(); lcd3.clear();
+//	lcd1.print("one"); lcd2.print("two"); lcd3.print("three");
+//	group.flush(); // or call group.poll() from loop()
+//
+// NOTE:
+//	Displays that are not using a queue buffer are sent their commands
+//	and data when the API functions are called and are ignored by the group.
+//
+// ---------------------------------------------------------------------------
+#ifndef hd44780_group_h
+#define hd44780_group_h
+
+class hd44780_group
+{
+public:
+// ====================
+// === constructors ===
+// ====================
+
+hd44780_group(hd44780 *lcds[], uint8_t nlcds) :
+	_lcds(lcds), _nlcds(nlcds), _next(0) { }
+
+// poll() - send queued entries to the displays that are ready
+// Keeps going around the displays until none of the displays with
+// queued entries is ready.
+// returns:
+//	success: number of entries still queued for all the displays
+//	failure: negative value
+int poll(void)
+{
+uint8_t sent;
+int rval = hd44780::RV_ENOERR;
+int status;
+
+	do
+	{
+		sent = 0;
+		for(uint8_t i = 0; i < _nlcds; i++)
+		{
+		hd44780 *lcd = _lcds[_next];
+
+			// start with a different display each time around
+			if(++_next >= _nlcds)
+				_next = 0;
+
+			if(lcd->queued() && lcd->ready())
+			{
+				if((status = lcd->poll()) < 0) // intentional assignment
+					rval = status;
+				sent = 1;
+			}
+		}
+	} while(sent);
+
+	if(rval)
+		return(rval);
+	return(queued());
+}
+
+// flush() - send all queued entries for all the displays
+// returns 0 on success, non zero on failure
+int flush(void)
+{
+int rval = hd44780::RV_ENOERR;
+int status;
+
+	while((status = poll())) // intentional assignment
+	{
+		if(status < 0)
+			rval = status;
+	}
+	return(rval);
+}
+
+// queued() - returns number of entries queued for all the displays
+int queued(void)
+{
+int n = 0;
+
+	for(uint8_t i = 0; i < _nlcds; i++)
+		n += _lcds[i]->queued();
+	return(n);
+}
+
+// readyInUs() - returns microseconds until a display with queued entries
+// is ready, 0 if one is ready now or nothing is queued
+uint32_t readyInUs(void)
+{
+uint32_t us = 0xffffffff;
+uint32_t t;
+
+	for(uint8_t i = 0; i < _nlcds; i++)
+	{
+		if(_lcds[i]->queued() && ((t = _lcds[i]->readyInUs()) < us)) // intentional assignment
+			us = t;
+	}
+	return((us == 0xffffffff) ? 0 : us);
+}
+
+private:
+hd44780 **_lcds;
+uint8_t _nlcds;
+uint8_t _next;		// display to start with on the next time around
+
+}; // end of class definition
+#endif
@@ -0,0 +1,234 @@
+//  vi:ts=4
+// ---------------------------------------------------------------------------
+//  hd44780_static.h - static i/o class binding for hd44780 library
+//
+// ---------------------------------------------------------------------------
+//
+//  This file is part of the hd44780 library
+//
+//  hd44780_static is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation version 3 of the License.
+//
+//  hd44780_static is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with hd44780_static.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ---------------------------------------------------------------------------
+//
+// hd44780_static is a template that wraps an i/o class so that characters
+// are sent by calling the i/o class iowrite() directly rather than
+// through the hd44780 virtual i/o functions.
+// Since the i/o class is known at compile time, the compiler can inline
+// the i/o class code into write(), which saves the indirect calls and
+// allows small i/o functions like the pinIO nibble writes to be inlined.
+// Buffers (print()) are handed to the i/o class iowriteBuf() when the
+// i/o class has one, like hd44780_I2Cexp, so bytes are still sent together.
+//
+// Everything else (commands, reads, shadow buffer, queue, etc...)
+// is done by the hd44780 class as usual, and write() falls back to the
+// hd44780 write() when one of those modes needs it.
+//
+// The constructor parameters are the same as the i/o class.
+//
+// An optional 2nd template parameter selects the features that are
+// supported. Features that are not selected are removed from write()
+// and the API functions that enable them return RV_ENOTSUP:
+//	HD44780_POLICY_WRAP  - line wrapping, lineWrap()
+//	HD44780_POLICY_READ  - read(), readBuf(), status(), busyPoll(),
+//	                       calibrateExecTimes()
+//	HD44780_POLICY_MODES - shadowBuffer(), queueBuffer(), marquee(),
+//	                       doubleBuffer(), setEnable2()
+//	HD44780_POLICY_TRACK - DDRAM address tracking for write()
+//	                       (setCursor() skips commands that are not needed)
+// The default is HD44780_POLICY_ALL.
+// HD44780_POLICY_WRITEONLY is the smallest and fastest write() for
+// sketches that only use setCursor(), print(), and write().
+//
+// The policy only applies to the character write path.
+// Commands, execution time tracking & waits (including the clear and
+// home timing), and the state for the shadow buffer, queue, marquee, etc.
+// are still handled at runtime by hd44780 and use the same RAM
+// regardless of the policy. The execution time strategy is selected at
+// runtime with setExecTimes(), busyPoll(), and setTimeSource().
+//
+// Usage:
+//	hd44780_static<hd44780_pinIO> lcd(rs, en, db4, db5, db6, db7);
+//	hd44780_static<hd44780_pinIO, HD44780_POLICY_WRITEONLY> lcd2(rs, en, db4, db5, db6, db7);
+//
+// The hd44780_pinIO StaticSpeed example compares the per byte time
+// with and without hd44780_static.
+//
+// NOTE:
+//	Requires C++11 (Arduino IDE 1.6.6 or later)
+//
+// ---------------------------------------------------------------------------
+#ifndef hd44780_static_h
+#define hd44780_static_h
+
+#if __cplusplus < 201103L
+#error hd44780_static requires C++11
+#endif
+
+// feature policy bits
+#define HD44780_POLICY_WRAP			0x01
+#define HD44780_POLICY_READ			0x02
+#define HD44780_POLICY_MODES		0x04
+#define HD44780_POLICY_TRACK		0x08
+#define HD44780_POLICY_ALL			0x0f
+#define HD44780_POLICY_WRITEONLY	0x00
+
+template <class IO, uint8_t POLICY = HD44780_POLICY_ALL>
+class hd44780_static : public IO
+{
+public:
+// ====================
+// === constructors ===
+// ====================
+
+template <typename... Args>
+hd44780_static(Args... args) : IO(args...) { }
+
+// write() - send a character using the i/o class directly
+// returns number of bytes successfully written to device
+size_t write(uint8_t value)
+{
+int status;
+
+	// POLICY is a constant so the compiler removes the unused checks
+	if((POLICY & (HD44780_POLICY_READ|HD44780_POLICY_MODES)) && !this->directData())
+		return(IO::write(value));
+	if((POLICY & HD44780_POLICY_WRAP) && this->_wraplines)
+		return(IO::write(value));
+
+	// qualified call so it is not a virtual function call
+	status = IO::iowrite(hd44780::HD44780_IOdata, value);
+	this->dataSent(status, POLICY & HD44780_POLICY_TRACK);
+	return(status ? 0 : 1);
+}
+
+// write() - send a buffer of characters
+// returns number of bytes successfully written to device
+size_t write(const uint8_t *buffer, size_t size)
+{
+size_t n = 0;
+
+	if((POLICY & (HD44780_POLICY_READ|HD44780_POLICY_MODES)) && !this->directData())
+		return(IO::write(buffer, size));
+	if((POLICY & HD44780_POLICY_WRAP) && this->_wraplines)
+		return(IO::write(buffer, size));
+
+	// i/o classes that can send several bytes together, like
+	// hd44780_I2Cexp, are handed the whole buffer
+	if(ioHasWriteBuf(&hd44780_static::iowriteBuf))
+	{
+	int status;
+
+		if(!size)
+			return(0);
+		// qualified call so it is not a virtual function call
+		status = IO::iowriteBuf(hd44780::HD44780_IOdata, buffer, size);
+		this->dataSent(status, POLICY & HD44780_POLICY_TRACK, size);
+		return(status ? 0 : size);
+	}
+
+	while((n < size) && hd44780_static::write(buffer[n]))
+		n++;
+	return(n);
+}
+using IO::write; // for other write() functions
+
+// features that are not selected by POLICY
+
+int lineWrap(void)
+{
+	if(!(POLICY & HD44780_POLICY_WRAP))
+		return(hd44780::RV_ENOTSUP);
+	return(IO::lineWrap());
+}
+
+int read(void)
+{
+	if(!(POLICY & HD44780_POLICY_READ))
+		return(hd44780::RV_ENOTSUP);
+	return(IO::read());
+}
+
+int readBuf(uint8_t *buf, size_t len)
+{
+	if(!(POLICY & HD44780_POLICY_READ))
+		return(hd44780::RV_ENOTSUP);
+	return(IO::readBuf(buf, len));
+}
+
+int status(void)
+{
+	if(!(POLICY & HD44780_POLICY_READ))
+		return(hd44780::RV_ENOTSUP);
+	return(IO::status());
+}
+
+int busyPoll(void)
+{
+	if(!(POLICY & HD44780_POLICY_READ))
+		return(hd44780::RV_ENOTSUP);
+	return(IO::busyPoll());
+}
+
+int calibrateExecTimes(uint8_t marginPct = hd44780::HD44780_CALMARGIN)
+{
+	if(!(POLICY & HD44780_POLICY_READ))
+		return(hd44780::RV_ENOTSUP);
+	return(IO::calibrateExecTimes(marginPct));
+}
+
+int shadowBuffer(uint8_t *buf, size_t size)
+{
+	if(!(POLICY & HD44780_POLICY_MODES))
+		return(hd44780::RV_ENOTSUP);
+	return(IO::shadowBuffer(buf, size));
+}
+
+int queueBuffer(uint8_t *buf, size_t size)
+{
+	if(!(POLICY & HD44780_POLICY_MODES))
+		return(hd44780::RV_ENOTSUP);
+	return(IO::queueBuffer(buf, size));
+}
+
+int marquee(uint8_t row, const char *text)
+{
+	if(!(POLICY & HD44780_POLICY_MODES))
+		return(hd44780::RV_ENOTSUP);
+	return(IO::marquee(row, text));
+}
+
+int doubleBuffer(void)
+{
+	if(!(POLICY & HD44780_POLICY_MODES))
+		return(hd44780::RV_ENOTSUP);
+	return(IO::doubleBuffer());
+}
+
+int setEnable2(uint8_t en2)
+{
+	if(!(POLICY & HD44780_POLICY_MODES))
+		return(hd44780::RV_ENOTSUP);
+	return(IO::setEnable2(en2));
+}
+
+private:
+// ioHasWriteBuf() - true when the i/o class has its own iowriteBuf()
+// rather than the hd44780 default that sends a byte at a time
+static constexpr bool ioHasWriteBuf(int (hd44780::*)(hd44780::iotype, const uint8_t *, size_t))
+	{ return(false); }
+template <class C>
+static constexpr bool ioHasWriteBuf(int (C::*)(hd44780::iotype, const uint8_t *, size_t))
+	{ return(true); }
+
+}; // end of class definition
+#endif